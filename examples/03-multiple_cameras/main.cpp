@@ -1,5 +1,6 @@
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "SaiGraphics.h"
 
@@ -34,11 +35,13 @@ int main() {
 		graphics->renderGraphicsWorld();
 
 		if (counter == 1000) {
-			// save camera images
-			graphics->getCameraImage("camera1")->saveToFile("camera1_image.png");
-			graphics->getCameraImage("camera2")->saveToFile("camera2_image.png");
-			graphics->getCameraImage("camera3")->saveToFile("camera3_image.png");
-			graphics->getCameraImage("camera4")->saveToFile("camera4_image.png");
+			// save camera images, rendered together with a single shadow pass
+			const vector<string> camera_names = {"camera1", "camera2",
+												 "camera3", "camera4"};
+			auto images = graphics->getCameraImages(camera_names);
+			for (int i = 0; i < camera_names.size(); ++i) {
+				images[i]->saveToFile(camera_names[i] + "_image.png");
+			}
 		}
 
 		counter++;
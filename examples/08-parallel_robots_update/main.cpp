@@ -0,0 +1,112 @@
+// This example benchmarks the batched robot update (updateRobotsGraphics)
+// against the serial one (updateRobotGraphics called for each robot) in
+// worlds containing an increasing number of robots, and for different sizes of
+// the update thread pool.
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "SaiGraphics.h"
+
+using namespace std;
+
+const string robot_folder = string(EXAMPLES_FOLDER) + "/03-multiple_cameras";
+const string world_file = "08-parallel_robots_update_world.urdf";
+const vector<int> robot_counts = {1, 4, 16, 32, 64};
+const vector<unsigned int> thread_counts = {1, 2, 4, 8};
+const int num_iterations = 500;
+
+// writes a world file containing num_robots copies of the sphbot robot laid
+// out on a grid
+void writeWorldFile(const int num_robots) {
+	ofstream file(world_file);
+	file << "<?xml version=\"1.0\" ?>\n";
+	file << "<world name=\"benchmark_world\" gravity=\"0.0 0.0 -9.81\">\n";
+	for (int i = 0; i < num_robots; ++i) {
+		file << "\t<robot name=\"robot" << i << "\">\n";
+		file << "\t\t<model dir=\"" << robot_folder
+			 << "\" path=\"sphbot.urdf\" name=\"SphBot_description\" />\n";
+		file << "\t\t<origin xyz=\"" << 2.0 * (i % 8) << " " << 2.0 * (i / 8)
+			 << " 0.0\" rpy=\"0 0 0\" />\n";
+		file << "\t</robot>\n";
+	}
+	file << "\t<light name=\"light\" type=\"directional\">\n";
+	file << "\t\t<position xyz=\"2.0 -2.0 2.0\" />\n";
+	file << "\t\t<lookat xyz=\"0.0 0.0 0.0\" />\n";
+	file << "\t</light>\n";
+	file << "\t<camera name=\"camera\">\n";
+	file << "\t\t<position xyz=\"-5.0 -5.0 5.0\" />\n";
+	file << "\t\t<vertical xyz=\"0.0 0.0 1.0\" />\n";
+	file << "\t\t<lookat xyz=\"0.0 0.0 0.0\" />\n";
+	file << "\t</camera>\n";
+	file << "</world>\n";
+}
+
+// returns the average time per iteration in microseconds
+template <typename F>
+double timeIterations(F&& update) {
+	auto start = chrono::steady_clock::now();
+	for (int k = 0; k < num_iterations; ++k) {
+		update(k);
+	}
+	auto end = chrono::steady_clock::now();
+	return chrono::duration<double, micro>(end - start).count() /
+		   num_iterations;
+}
+
+int main() {
+	writeWorldFile(1);
+	auto graphics = new SaiGraphics::SaiGraphics(world_file);
+
+	cout << endl
+		 << "Average time per update of all the robots, in microseconds"
+		 << endl;
+	cout << setw(8) << "robots" << setw(12) << "serial";
+	for (auto num_threads : thread_counts) {
+		cout << setw(10) << "batch x" << num_threads;
+	}
+	cout << endl;
+
+	for (int num_robots : robot_counts) {
+		writeWorldFile(num_robots);
+		graphics->resetWorld(world_file);
+
+		vector<SaiGraphics::RobotHandle> robots;
+		vector<Eigen::VectorXd> robot_q;
+		for (const auto& robot_name : graphics->getRobotNames()) {
+			robots.push_back(graphics->getRobotHandle(robot_name));
+			robot_q.push_back(graphics->getRobotJointPos(robot_name));
+		}
+
+		double serial_time = timeIterations([&](int k) {
+			for (int i = 0; i < robots.size(); ++i) {
+				robot_q[i].setConstant(0.01 * k);
+				graphics->updateRobotGraphics(robots[i], robot_q[i]);
+			}
+		});
+		cout << setw(8) << num_robots << setw(12) << fixed << setprecision(1)
+			 << serial_time;
+
+		for (auto num_threads : thread_counts) {
+			graphics->setNumUpdateThreads(num_threads);
+			double batch_time = timeIterations([&](int k) {
+				for (auto& q : robot_q) {
+					q.setConstant(0.01 * k);
+				}
+				graphics->updateRobotsGraphics(robots, robot_q);
+			});
+			cout << setw(11) << batch_time;
+		}
+		cout << endl;
+
+		// show the last configuration
+		graphics->renderGraphicsWorld();
+	}
+
+	delete graphics;
+	return 0;
+}
@@ -0,0 +1,88 @@
+// This example runs a simple simulation of the pendulum and cube from example
+// 05 at 1 kHz in its own thread, while the main thread runs the rendering loop
+// at 30 Hz. The simulation publishes the states without ever waiting for the
+// rendering, and reads the ui torques to let the user push the pendulum.
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "SaiGraphics.h"
+
+using namespace std;
+
+const string world_file =
+	string(EXAMPLES_FOLDER) + "/05-apply_ui_force/world.urdf";
+const string robot_name = "RBot";
+const string object_name = "Box";
+
+std::atomic<bool> simulation_running(true);
+
+void simulation(std::shared_ptr<SaiGraphics::SaiGraphics> graphics,
+				const SaiGraphics::RobotHandle robot,
+				const SaiGraphics::ObjectHandle object,
+				Eigen::VectorXd robot_q, Eigen::Affine3d object_pose) {
+	Eigen::VectorXd robot_dq = Eigen::VectorXd::Zero(robot_q.size());
+
+	// the ui torques are only published by the render loop once it runs
+	while (simulation_running && !graphics->isRenderLoopRunning()) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	const double dt = 0.001;
+	unsigned long long counter = 0;
+	auto next_step_time = std::chrono::steady_clock::now();
+	while (simulation_running) {
+		// damped pendulum pushed by the ui torques
+		Eigen::VectorXd robot_ddq = graphics->getUITorques(robot_name) -
+									2.0 * robot_dq -
+									10.0 * robot_q.array().sin().matrix();
+		robot_dq += dt * robot_ddq;
+		robot_q += dt * robot_dq;
+
+		// the cube follows a prescribed motion
+		object_pose.translation()(1) = -0.4 * sin((double)counter / 1000);
+		object_pose.linear() *=
+			AngleAxisd(1.0 / 1000.0, Eigen::Vector3d::UnitX())
+				.toRotationMatrix();
+
+		// publish the states, this never blocks
+		graphics->publishRobotState(robot, robot_q, robot_dq);
+		graphics->publishObjectState(object, object_pose);
+
+		counter++;
+		next_step_time += std::chrono::microseconds(1000);
+		std::this_thread::sleep_until(next_step_time);
+	}
+	cout << "simulation ran " << counter << " steps" << endl;
+}
+
+int main() {
+	cout << "Loading URDF world model file: " << world_file << endl;
+
+	// load graphics scene
+	auto graphics = std::make_shared<SaiGraphics::SaiGraphics>(world_file);
+	graphics->addUIForceInteraction(robot_name);
+
+	cout << endl
+		 << "The simulation runs at 1 kHz in a separate thread while the "
+			"window is rendered at 30 Hz. Right click and drag on the pendulum "
+			"to push it."
+		 << endl
+		 << endl;
+
+	// start the simulation and render until the window is closed
+	std::thread simulation_thread(simulation, graphics,
+								  graphics->getRobotHandle(robot_name),
+								  graphics->getObjectHandle(object_name),
+								  graphics->getRobotJointPos(robot_name),
+								  graphics->getObjectPose(object_name));
+	graphics->runRenderLoop(30.0);
+
+	simulation_running = false;
+	simulation_thread.join();
+
+	return 0;
+}
@@ -0,0 +1,56 @@
+// This example renders the world of example 02 without any window, in an
+// offscreen EGL context. It can run on a machine without a display (for
+// example a server using the Mesa llvmpipe software renderer) and saves a few
+// camera images while the pendulum and the cube move.
+
+#include <iostream>
+#include <string>
+
+#include "SaiGraphics.h"
+
+using namespace std;
+
+const string world_file =
+	string(EXAMPLES_FOLDER) + "/02-update_rendering/world.urdf";
+const string robot_name = "RBot";
+const string object_name = "Box";
+const string camera_name = "camera";
+
+int main() {
+	if (!SaiGraphics::HeadlessContext::isSupported()) {
+		cout << "sai-graphics was built without EGL support, cannot run the "
+				"headless example"
+			 << endl;
+		return 0;
+	}
+	cout << "Loading URDF world model file: " << world_file << endl;
+
+	// load graphics scene without a window
+	auto graphics = std::make_shared<SaiGraphics::SaiGraphics>(
+		world_file, "sai world", false, true);
+
+	const SaiGraphics::RobotHandle robot = graphics->getRobotHandle(robot_name);
+	const SaiGraphics::ObjectHandle object =
+		graphics->getObjectHandle(object_name);
+	const SaiGraphics::CameraHandle camera =
+		graphics->getCameraHandle(camera_name);
+
+	Eigen::VectorXd robot_q = graphics->getRobotJointPos(robot_name);
+	Eigen::Affine3d object_pose = graphics->getObjectPose(object_name);
+
+	for (int counter = 0; counter <= 500; ++counter) {
+		robot_q << (double)counter / 100.0;
+		object_pose.translation()(1) = -0.4 * sin((double)counter / 100);
+		graphics->updateRobotGraphics(robot, robot_q);
+		graphics->updateObjectGraphics(object, object_pose);
+
+		if (counter % 100 == 0) {
+			const string filename =
+				"headless_image_" + to_string(counter / 100) + ".png";
+			graphics->getCameraImage(camera, 640, 480)->saveToFile(filename);
+			cout << "saved " << filename << endl;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,118 @@
+// This example publishes the images of a camera to a ring buffer in shared
+// memory, and reads them from a separate consumer process. The consumer only
+// uses SharedFrameRing.h: it maps the frames in place, without copies, and
+// skips the frames that were overwritten while it used them. Example 12
+// verifies the published frames without a window.
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "SaiGraphics.h"
+
+using namespace std;
+
+const string world_file =
+	string(EXAMPLES_FOLDER) + "/02-update_rendering/world.urdf";
+const string robot_name = "RBot";
+const string object_name = "Box";
+const string camera_name = "camera";
+const string shared_memory_name = "sai_example_camera_frames";
+
+// consumer process: prints the latest frame once per second
+int runConsumer(const pid_t producer_pid) {
+	// wait for the producer to create the ring
+	unique_ptr<SaiGraphics::SharedFrameReader> reader;
+	while (!reader) {
+		try {
+			reader = make_unique<SaiGraphics::SharedFrameReader>(
+				shared_memory_name);
+		} catch (const runtime_error&) {
+			this_thread::sleep_for(chrono::milliseconds(100));
+		}
+		if (getppid() != producer_pid) {
+			return 0;
+		}
+	}
+
+	unsigned long long num_torn_frames = 0;
+	while (getppid() == producer_pid) {
+		SaiGraphics::SharedFrameView frame;
+		if (reader->acquireLatestFrame(frame)) {
+			// average intensity of the frame, read in place
+			unsigned long long sum = 0;
+			for (uint32_t row = 0; row < frame.info.height; ++row) {
+				const unsigned char* pixels =
+					frame.data + (size_t)row * frame.info.row_stride;
+				for (uint32_t col = 0; col < frame.info.width; ++col) {
+					sum += pixels[4 * col] + pixels[4 * col + 1] +
+						   pixels[4 * col + 2];
+				}
+			}
+			if (reader->isFrameValid(frame)) {
+				cout << "consumer: frame " << frame.info.frame_number << " ("
+					 << frame.info.width << "x" << frame.info.height
+					 << ") at time " << frame.info.timestamp
+					 << ", mean intensity "
+					 << sum / (3.0 * frame.info.width * frame.info.height)
+					 << ", torn frames so far " << num_torn_frames << endl;
+			} else {
+				++num_torn_frames;
+			}
+		}
+		this_thread::sleep_for(chrono::seconds(1));
+	}
+	return 0;
+}
+
+int main() {
+	// the consumer is forked before any graphics or thread is created
+	const pid_t producer_pid = getpid();
+	const pid_t consumer_pid = fork();
+	if (consumer_pid == 0) {
+		return runConsumer(producer_pid);
+	}
+
+	cout << "Loading URDF world model file: " << world_file << endl;
+	auto graphics =
+		new SaiGraphics::SaiGraphics(world_file, "sai world", false);
+	graphics->publishCameraFrames(camera_name, shared_memory_name);
+
+	const SaiGraphics::CameraHandle camera =
+		graphics->getCameraHandle(camera_name);
+	chai3d::cImagePtr image = chai3d::cImage::create();
+	Eigen::VectorXd robot_q = graphics->getRobotJointPos(robot_name);
+	Eigen::Affine3d object_pose = graphics->getObjectPose(object_name);
+
+	cout << endl
+		 << "The images of the camera are published in the shared memory "
+			"segment "
+		 << shared_memory_name << " and read by a consumer process" << endl;
+
+	unsigned long long counter = 0;
+	while (graphics->isWindowOpen()) {
+		const double time = counter / 100.0;
+		robot_q << time;
+		object_pose.translation()(1) = -0.4 * sin(time);
+		graphics->updateRobotGraphics(robot_name, robot_q);
+		graphics->updateObjectGraphics(object_name, object_pose);
+		graphics->renderGraphicsWorld();
+
+		// each capture is also published in shared memory
+		if (counter % 10 == 0) {
+			graphics->setSimulationTime(time);
+			graphics->getCameraImage(camera, image, 640, 480);
+		}
+		counter++;
+	}
+
+	delete graphics;
+	kill(consumer_pid, SIGTERM);
+	waitpid(consumer_pid, NULL, 0);
+	return 0;
+}
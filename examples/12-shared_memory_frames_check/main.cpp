@@ -0,0 +1,298 @@
+// This example checks the frames published in shared memory from a forked
+// reader process, and exits with a non zero status if a frame is wrong. It
+// runs without any window:
+// - first, frames with a known pixel pattern are written to a ring as fast as
+//   possible while the reader verifies each frame it reads. Frames overwritten
+//   during a read must be detected by SharedFrameReader::isFrameValid, a frame
+//   that is wrong but seen as valid is a failure.
+// - then, if the headless rendering is supported, the images of a camera of
+//   example 02 are published with publishCameraFrames, one at a time, and the
+//   reader compares them with a checksum of the captured images sent through a
+//   pipe.
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SaiGraphics.h"
+
+using namespace std;
+
+const string world_file =
+	string(EXAMPLES_FOLDER) + "/02-update_rendering/world.urdf";
+const string camera_name = "camera";
+const string pattern_memory_name = "sai_example_frames_check_pattern";
+const string camera_memory_name = "sai_example_frames_check_camera";
+
+// frames of the pattern check
+const uint32_t pattern_width = 64;
+const uint32_t pattern_height = 48;
+const uint64_t num_pattern_frames = 20000;
+const unsigned int num_pattern_slots = 4;
+
+// frames of the camera check
+const int camera_width = 320;
+const int camera_height = 240;
+const uint64_t num_camera_frames = 50;
+
+// simulation time of a frame
+double frameTimestamp(const uint64_t frame_number) {
+	return 1e-3 * frame_number;
+}
+
+// known value of the byte i of a frame
+unsigned char patternByte(const uint64_t frame_number, const size_t i) {
+	return (unsigned char)(frame_number * 13 + i);
+}
+
+// FNV-1a hash of the pixels of an image
+uint64_t checksum(const unsigned char* data, const size_t size) {
+	uint64_t hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < size; ++i) {
+		hash = (hash ^ data[i]) * 1099511628211ULL;
+	}
+	return hash;
+}
+
+// checks the description of a frame, and prints the first error
+bool checkFrameInfo(const SaiGraphics::SharedFrameInfo& info,
+					const uint32_t width, const uint32_t height,
+					const uint64_t min_frame_number, const double timestamp) {
+	string error;
+	if (info.width != width || info.height != height) {
+		error = "wrong size " + to_string(info.width) + "x" +
+				to_string(info.height);
+	} else if (info.format != SaiGraphics::SharedFrameInfo::RGBA8) {
+		error = "wrong format " + to_string(info.format);
+	} else if (info.row_stride != 4 * width) {
+		error = "wrong row stride " + to_string(info.row_stride);
+	} else if (info.frame_number < min_frame_number) {
+		error = "frame number going back to " + to_string(info.frame_number);
+	} else if (info.timestamp != timestamp) {
+		error = "wrong timestamp " + to_string(info.timestamp);
+	}
+	if (!error.empty()) {
+		cout << "reader: frame " << info.frame_number << ": " << error << endl;
+		return false;
+	}
+	return true;
+}
+
+// reads the pattern frames until the last one, returns the exit status
+int checkPatternFrames() {
+	SaiGraphics::SharedFrameReader reader(pattern_memory_name);
+	const size_t frame_size = 4 * (size_t)pattern_width * pattern_height;
+	uint64_t last_frame_number = 0;
+	unsigned long long num_valid_frames = 0;
+	unsigned long long num_torn_frames = 0;
+	while (last_frame_number < num_pattern_frames) {
+		SaiGraphics::SharedFrameView frame;
+		if (!reader.acquireLatestFrame(frame)) {
+			continue;
+		}
+		// the frame is read in place before being validated
+		const SaiGraphics::SharedFrameInfo info = frame.info;
+		size_t num_wrong_bytes = 0;
+		for (size_t i = 0; i < frame_size; ++i) {
+			num_wrong_bytes +=
+				frame.data[i] != patternByte(info.frame_number, i);
+		}
+		if (!reader.isFrameValid(frame)) {
+			++num_torn_frames;
+			continue;
+		}
+		if (!checkFrameInfo(info, pattern_width, pattern_height,
+							last_frame_number,
+							frameTimestamp(info.frame_number))) {
+			return 1;
+		}
+		if (num_wrong_bytes > 0) {
+			cout << "reader: frame " << info.frame_number << " has "
+				 << num_wrong_bytes
+				 << " wrong bytes but was not detected as overwritten" << endl;
+			return 1;
+		}
+		last_frame_number = info.frame_number;
+		++num_valid_frames;
+	}
+	cout << "reader: " << num_valid_frames << " pattern frames verified, "
+		 << num_torn_frames << " overwritten frames detected" << endl;
+	return 0;
+}
+
+// checks the frames of a ring filled with the known pattern
+bool runPatternCheck() {
+	// the ring exists before the reader is forked
+	SaiGraphics::SharedFrameWriter writer(
+		pattern_memory_name, num_pattern_slots,
+		4 * (size_t)pattern_width * pattern_height);
+	const pid_t reader_pid = fork();
+	if (reader_pid == 0) {
+		// the child does not destroy the writer of the parent
+		_exit(checkPatternFrames());
+	}
+
+	const size_t frame_size = 4 * (size_t)pattern_width * pattern_height;
+	for (uint64_t frame_number = 1; frame_number <= num_pattern_frames;
+		 ++frame_number) {
+		unsigned char* data =
+			writer.beginFrame(pattern_width, pattern_height,
+							  SaiGraphics::SharedFrameInfo::RGBA8,
+							  frameTimestamp(frame_number));
+		for (size_t i = 0; i < frame_size; ++i) {
+			data[i] = patternByte(frame_number, i);
+		}
+		writer.endFrame();
+	}
+
+	int status = 0;
+	waitpid(reader_pid, &status, 0);
+	return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// frame published by the camera, sent to the reader through a pipe
+struct ExpectedFrame {
+	uint64_t frame_number;
+	double timestamp;
+	uint64_t checksum;
+};
+
+bool readAll(const int fd, void* data, const size_t size) {
+	size_t num_read = 0;
+	while (num_read < size) {
+		const ssize_t n =
+			read(fd, static_cast<char*>(data) + num_read, size - num_read);
+		if (n <= 0) {
+			return false;
+		}
+		num_read += n;
+	}
+	return true;
+}
+
+bool writeAll(const int fd, const void* data, const size_t size) {
+	return write(fd, data, size) == (ssize_t)size;
+}
+
+// verifies each camera frame announced by the producer, returns the exit
+// status
+int checkCameraFrames(const int expected_fd, const int ack_fd) {
+	unique_ptr<SaiGraphics::SharedFrameReader> reader;
+	for (uint64_t i = 0; i < num_camera_frames; ++i) {
+		ExpectedFrame expected;
+		if (!readAll(expected_fd, &expected, sizeof(expected))) {
+			cout << "reader: the camera producer stopped early" << endl;
+			return 1;
+		}
+		// the segment exists once the first frame is announced
+		if (!reader) {
+			reader =
+				make_unique<SaiGraphics::SharedFrameReader>(camera_memory_name);
+		}
+		vector<unsigned char> data;
+		SaiGraphics::SharedFrameInfo info;
+		if (!reader->copyLatestFrame(data, info)) {
+			cout << "reader: no camera frame " << expected.frame_number
+				 << endl;
+			return 1;
+		}
+		if (!checkFrameInfo(info, camera_width, camera_height,
+							expected.frame_number, expected.timestamp)) {
+			return 1;
+		}
+		if (info.frame_number != expected.frame_number ||
+			checksum(data.data(), data.size()) != expected.checksum) {
+			cout << "reader: camera frame " << info.frame_number
+				 << " differs from the captured image" << endl;
+			return 1;
+		}
+		const char ack = 1;
+		writeAll(ack_fd, &ack, 1);
+	}
+	cout << "reader: " << num_camera_frames << " camera frames verified"
+		 << endl;
+	return 0;
+}
+
+// checks the camera images published by SaiGraphics
+bool runCameraCheck() {
+	int expected_pipe[2];
+	int ack_pipe[2];
+	if (pipe(expected_pipe) != 0 || pipe(ack_pipe) != 0) {
+		cout << "could not create the pipes of the camera check" << endl;
+		return false;
+	}
+	// the reader is forked before any graphics or thread is created
+	const pid_t reader_pid = fork();
+	if (reader_pid == 0) {
+		close(expected_pipe[1]);
+		close(ack_pipe[0]);
+		_exit(checkCameraFrames(expected_pipe[0], ack_pipe[1]));
+	}
+	close(expected_pipe[0]);
+	close(ack_pipe[1]);
+	// a reader that exits early makes the writes fail instead of killing the
+	// producer
+	signal(SIGPIPE, SIG_IGN);
+
+	bool producer_ok = true;
+	{
+		auto graphics = make_unique<SaiGraphics::SaiGraphics>(
+			world_file, "sai world", false, true);
+		graphics->publishCameraFrames(camera_name, camera_memory_name);
+		const SaiGraphics::CameraHandle camera =
+			graphics->getCameraHandle(camera_name);
+		vector<unsigned char> pixels(4 * (size_t)camera_width * camera_height);
+
+		// one frame at a time, so that the reader sees all of them
+		for (uint64_t frame_number = 1; frame_number <= num_camera_frames;
+			 ++frame_number) {
+			const double timestamp = frameTimestamp(frame_number);
+			graphics->setSimulationTime(timestamp);
+			graphics->getCameraImage(camera, pixels.data(), camera_width,
+									 camera_height);
+			const ExpectedFrame expected = {
+				frame_number, timestamp,
+				checksum(pixels.data(), pixels.size())};
+			char ack;
+			if (!writeAll(expected_pipe[1], &expected, sizeof(expected)) ||
+				!readAll(ack_pipe[0], &ack, 1)) {
+				producer_ok = false;
+				break;
+			}
+		}
+	}
+	close(expected_pipe[1]);
+	close(ack_pipe[0]);
+
+	int status = 0;
+	waitpid(reader_pid, &status, 0);
+	return producer_ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int main() {
+	if (!runPatternCheck()) {
+		cout << "FAILED: shared memory pattern frames" << endl;
+		return 1;
+	}
+	cout << "shared memory pattern frames: OK" << endl;
+
+	if (!SaiGraphics::HeadlessContext::isSupported()) {
+		cout << "sai-graphics was built without EGL support, the camera "
+				"frames are not checked"
+			 << endl;
+		return 0;
+	}
+	if (!runCameraCheck()) {
+		cout << "FAILED: shared memory camera frames" << endl;
+		return 1;
+	}
+	cout << "shared memory camera frames: OK" << endl;
+	return 0;
+}
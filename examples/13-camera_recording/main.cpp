@@ -0,0 +1,93 @@
+// This example records the view of a camera to a video file in the background
+// while the pendulum and the cube of example 02 move. The recording is started
+// and stopped with the R key, and stops by itself after a few seconds, as
+// uncompressed videos fill the disk quickly (about 15 MB/s here). It is
+// encoded in motion JPEG if ffmpeg is available.
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "SaiGraphics.h"
+
+using namespace std;
+
+const string world_file =
+	string(EXAMPLES_FOLDER) + "/02-update_rendering/world.urdf";
+const string robot_name = "RBot";
+const string object_name = "Box";
+const string camera_name = "camera";
+
+// maximum duration of a recording in seconds
+const double max_recording_duration = 5.0;
+const double recording_fps = 30.0;
+const int recording_width = 480;
+const int recording_height = 360;
+
+int main() {
+	cout << "Loading URDF world model file: " << world_file << endl;
+
+	// load graphics scene
+	auto graphics =
+		new SaiGraphics::SaiGraphics(world_file, "sai world", false);
+
+	const bool use_mjpeg = SaiGraphics::VideoRecorder::isMJPEGAvailable();
+	const SaiGraphics::VideoRecorder::Format format =
+		use_mjpeg ? SaiGraphics::VideoRecorder::MJPEG
+				  : SaiGraphics::VideoRecorder::Y4M;
+	const string video_file =
+		use_mjpeg ? "camera_recording.avi" : "camera_recording.y4m";
+
+	Eigen::VectorXd robot_q = graphics->getRobotJointPos(robot_name);
+	Eigen::Affine3d object_pose = graphics->getObjectPose(object_name);
+
+	cout << endl
+		 << "Press the R key to start or stop recording the view of the "
+			"camera to "
+		 << video_file << ". A recording stops after "
+		 << max_recording_duration << " seconds." << endl;
+
+	unsigned long long counter = 0;
+	bool r_key_was_pressed = false;
+	chrono::steady_clock::time_point recording_end;
+	while (graphics->isWindowOpen()) {
+		robot_q << (double)counter / 100.0;
+		object_pose.translation()(1) = -0.4 * sin((double)counter / 100);
+		graphics->updateRobotGraphics(robot_name, robot_q);
+		graphics->updateObjectGraphics(object_name, object_pose);
+		graphics->renderGraphicsWorld();
+
+		// toggle the recording when the key goes down
+		const bool r_key_pressed = graphics->isKeyPressed(GLFW_KEY_R);
+		const bool toggle = r_key_pressed && !r_key_was_pressed;
+		r_key_was_pressed = r_key_pressed;
+
+		const bool recording = graphics->isRecording(camera_name);
+		const bool recording_timeout =
+			recording && chrono::steady_clock::now() >= recording_end;
+		if (!recording && toggle) {
+			graphics->startRecording(camera_name, video_file, recording_fps,
+									 format, recording_width,
+									 recording_height);
+			recording_end =
+				chrono::steady_clock::now() +
+				chrono::duration_cast<chrono::steady_clock::duration>(
+					chrono::duration<double>(max_recording_duration));
+			cout << "recording started" << endl;
+		} else if (recording && (toggle || recording_timeout)) {
+			const auto statistics = graphics->stopRecording(camera_name);
+			cout << "recorded " << statistics.frames_written << " frames ("
+				 << statistics.frames_dropped << " dropped)"
+				 << (statistics.write_failed ? ", writing the video failed"
+											 : "")
+				 << endl;
+		}
+		counter++;
+	}
+
+	if (graphics->isRecording(camera_name)) {
+		graphics->stopRecording(camera_name);
+	}
+	delete graphics;
+	return 0;
+}
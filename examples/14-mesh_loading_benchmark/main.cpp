@@ -0,0 +1,165 @@
+// This example benchmarks the loading of a world containing many mesh files,
+// with the files decoded serially and by an increasing number of threads. The
+// mesh files and the world file are written to a temporary directory, removed
+// at the end.
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SaiGraphics.h"
+#include "parser/UrdfToSaiGraphics.h"
+
+using namespace std;
+
+// prefix of the paths of the mesh files in the world file
+const string folder_prefix = "MESH_LOADING_BENCHMARK_FOLDER";
+const int num_mesh_files = 128;
+// the spheres of the mesh files have mesh_slices slices and mesh_slices - 1
+// stacks, enough to get levels of detail
+const int mesh_slices = 50;
+const vector<unsigned int> loading_thread_counts = {1, 2, 4, 8, 0};
+
+// number of triangles of a sphere: two per quad, except at the poles where
+// the quads are single triangles
+int numSphereTriangles() { return 2 * mesh_slices * (mesh_slices - 2); }
+
+// writes a binary stl file of a sphere
+void writeSphereStl(const string& filename, const double radius) {
+	vector<float> triangles;
+	auto point = [&](int i, int j, float* p) {
+		const double theta = M_PI * i / (mesh_slices - 1);
+		const double phi = 2.0 * M_PI * j / mesh_slices;
+		p[0] = radius * sin(theta) * cos(phi);
+		p[1] = radius * sin(theta) * sin(phi);
+		p[2] = radius * cos(theta);
+	};
+	auto addTriangle = [&](const float* p0, const float* p1, const float* p2) {
+		// normal, recomputed by the loader
+		triangles.insert(triangles.end(), {0.0f, 0.0f, 0.0f});
+		triangles.insert(triangles.end(), p0, p0 + 3);
+		triangles.insert(triangles.end(), p1, p1 + 3);
+		triangles.insert(triangles.end(), p2, p2 + 3);
+	};
+	for (int i = 0; i + 1 < mesh_slices; ++i) {
+		for (int j = 0; j < mesh_slices; ++j) {
+			float p[4][3];
+			point(i, j, p[0]);
+			point(i, j + 1, p[1]);
+			point(i + 1, j, p[2]);
+			point(i + 1, j + 1, p[3]);
+			// the two top corners of the first row are the north pole, and the
+			// two bottom corners of the last row are the south pole
+			if (i > 0) {
+				addTriangle(p[0], p[2], p[1]);
+			}
+			if (i + 2 < mesh_slices) {
+				addTriangle(p[1], p[2], p[3]);
+			}
+		}
+	}
+	ofstream file(filename, ios::binary);
+	const char header[80] = "sai-graphics mesh loading benchmark";
+	file.write(header, sizeof(header));
+	const uint32_t num_triangles = triangles.size() / 12;
+	file.write((const char*)&num_triangles, sizeof(num_triangles));
+	const uint16_t attributes = 0;
+	for (uint32_t t = 0; t < num_triangles; ++t) {
+		file.write((const char*)&triangles[12 * t], 12 * sizeof(float));
+		file.write((const char*)&attributes, sizeof(attributes));
+	}
+}
+
+// writes num_mesh_files different mesh files in the folder, and a world file
+// containing one static object per mesh file. Returns the path of the world
+// file
+string writeMeshWorldFile(const filesystem::path& folder) {
+	const filesystem::path world_file = folder / "world.urdf";
+	ofstream file(world_file);
+	file << "<?xml version=\"1.0\" ?>\n";
+	file << "<world name=\"mesh_world\" gravity=\"0.0 0.0 -9.81\">\n";
+	for (int i = 0; i < num_mesh_files; ++i) {
+		const string mesh_file = "sphere" + to_string(i) + ".stl";
+		writeSphereStl((folder / mesh_file).string(), 0.05 + 0.001 * i);
+		file << "\t<static_object name=\"object" << i << "\">\n";
+		file << "\t\t<origin xyz=\"" << 0.5 * (i % 16) << " "
+			 << 0.5 * (i / 16) << " 0.0\" rpy=\"0 0 0\" />\n";
+		file << "\t\t<visual>\n";
+		file << "\t\t\t<origin xyz=\"0.0 0.0 0.0\" rpy=\"0 0 0\" />\n";
+		file << "\t\t\t<geometry>\n";
+		file << "\t\t\t\t<mesh filename=\"${" << folder_prefix << "}/"
+			 << mesh_file << "\" scale=\"1 1 1\" />\n";
+		file << "\t\t\t</geometry>\n";
+		file << "\t\t</visual>\n";
+		file << "\t</static_object>\n";
+	}
+	file << "</world>\n";
+	return world_file.string();
+}
+
+// returns the time to parse the world in seconds, with the mesh files decoded
+// by the given number of threads
+double timeMeshWorldLoading(const string& world_file,
+							const unsigned int num_threads) {
+	map<string, string> robot_filenames;
+	map<string, shared_ptr<Eigen::Affine3d>> dyn_object_poses;
+	map<string, shared_ptr<Eigen::Affine3d>> static_object_poses;
+	map<string, chai3d::cFrameBufferPtr> camera_frame_buffers;
+	chai3d::cWorld* world = new chai3d::cWorld();
+	auto start = chrono::steady_clock::now();
+	{
+		Parser::MeshCache mesh_cache(num_threads);
+		Parser::UrdfToSaiGraphicsWorld(
+			world_file, world, robot_filenames, dyn_object_poses,
+			static_object_poses, camera_frame_buffers, false, &mesh_cache);
+	}
+	auto end = chrono::steady_clock::now();
+	delete world;
+	return chrono::duration<double>(end - start).count();
+}
+
+int main() {
+	const filesystem::path folder =
+		filesystem::temp_directory_path() /
+		("sai-graphics-mesh-loading-" + to_string(getpid()));
+	filesystem::create_directories(folder);
+	SaiModel::URDF_FOLDERS[folder_prefix] = folder.string();
+	const string world_file = writeMeshWorldFile(folder);
+
+	cout << "Time to load a world with " << num_mesh_files
+		 << " mesh files of " << numSphereTriangles()
+		 << " triangles, in seconds (" << thread::hardware_concurrency()
+		 << " hardware threads)" << endl;
+	cout << setw(8) << "threads" << setw(12) << "time" << setw(12)
+		 << "speedup" << endl;
+	// first load to get the files in the disk cache
+	timeMeshWorldLoading(world_file, 1);
+	double serial_time = 0.0;
+	for (auto num_threads : loading_thread_counts) {
+		const double loading_time =
+			timeMeshWorldLoading(world_file, num_threads);
+		if (num_threads == 1) {
+			serial_time = loading_time;
+		}
+		// 0 threads is one thread per hardware thread
+		cout << setw(8)
+			 << (num_threads == 0 ? string("all") : to_string(num_threads))
+			 << setw(12) << fixed << setprecision(3) << loading_time
+			 << setw(12) << setprecision(2) << serial_time / loading_time
+			 << endl;
+	}
+
+	filesystem::remove_all(folder);
+	return 0;
+}
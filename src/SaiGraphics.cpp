@@ -7,6 +7,9 @@
 
 #include "SaiGraphics.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <deque>
 #include <iostream>
 #include <unordered_map>
@@ -138,12 +141,14 @@ GLFWwindow* glfwInitialize(const std::string& window_name) {
 	glfwInit();
 
 	// retrieve resolution of computer display and position window accordingly
+	// (there may be no monitor, for example with a virtual display)
 	GLFWmonitor* primary = glfwGetPrimaryMonitor();
-	const GLFWvidmode* mode = glfwGetVideoMode(primary);
+	const GLFWvidmode* mode =
+		primary != NULL ? glfwGetVideoMode(primary) : NULL;
 
 	// information about computer screen and GLUT display window
-	int screenW = mode->width;
-	int screenH = mode->height;
+	int screenW = mode != NULL ? mode->width : 1920;
+	int screenH = mode != NULL ? mode->height : 1080;
 	int windowW = 0.5 * screenW;
 	int windowH = 0.5 * screenH;
 	int windowPosY = (screenH - windowH) / 2;
@@ -160,29 +165,66 @@ GLFWwindow* glfwInitialize(const std::string& window_name) {
 
 	return window;
 }
+
+// current time of the steady clock in seconds
+double steadyClockTime() {
+	return std::chrono::duration<double>(
+			   std::chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
+
+// returns true if all the coefficients of a and b differ by at most tolerance
+template <typename DerivedA, typename DerivedB>
+bool isWithinTolerance(const Eigen::MatrixBase<DerivedA>& a,
+					   const Eigen::MatrixBase<DerivedB>& b,
+					   const double tolerance) {
+	if (a.rows() != b.rows() || a.cols() != b.cols()) {
+		return false;
+	}
+	if (tolerance == 0) {
+		return a == b;
+	}
+	return ((a - b).cwiseAbs().array() <= tolerance).all();
+}
 }  // namespace
 
 namespace SaiGraphics {
 
 SaiGraphics::SaiGraphics(const std::string& path_to_world_file,
-						   const std::string& window_name, bool verbose) {
+						   const std::string& window_name, bool verbose,
+						   const bool headless,
+						   const Parser::TessellationSettings& tessellation) {
 	// initialize a chai world
+	_world_id = 0;
+	_update_tolerance = 0.0;
+	_state_interpolation_enabled = false;
+	_max_extrapolation_time = 0.0;
+	_num_camera_readback_buffers = 2;
+	_next_camera_image_request_id = 1;
+	_simulation_time = 0.0;
+	_render_loop_running = false;
+	_render_loop_stop_requested = false;
+	setTessellationSettings(tessellation);
 	initializeWorld(path_to_world_file, verbose);
 #ifdef MACOSX
 	auto path = std::__fs::filesystem::current_path();
-	initializeWindow(window_name);
+	initializeWindow(window_name, headless);
 	std::__fs::filesystem::current_path(path);
 #else
-	initializeWindow(window_name);
+	initializeWindow(window_name, headless);
 #endif
 }
 
 // dtor
 SaiGraphics::~SaiGraphics() {
-	glfwDestroyWindow(_window);
-	glfwTerminate();
+	// clear the world first, while the OpenGL context still exists
 	clearWorld();
 	_world = NULL;
+	if (_window != NULL) {
+		glfwDestroyWindow(_window);
+		glfwTerminate();
+	}
+	_headless_context.reset();
 }
 
 void SaiGraphics::resetWorld(const std::string& path_to_world_file,
@@ -191,42 +233,91 @@ void SaiGraphics::resetWorld(const std::string& path_to_world_file,
 	initializeWorld(path_to_world_file, verbose);
 }
 
+void SaiGraphics::resetWorld(const std::string& path_to_world_file,
+							  const Parser::TessellationSettings& tessellation,
+							  const bool verbose) {
+	// invalid settings are rejected before the current world is cleared
+	setTessellationSettings(tessellation);
+	resetWorld(path_to_world_file, verbose);
+}
+
 void SaiGraphics::initializeWorld(const std::string& path_to_world_file,
 								   const bool verbose) {
 	_world = new chai3d::cWorld();
 	Parser::UrdfToSaiGraphicsWorld(
 		path_to_world_file, _world, _robot_filenames, _dyn_objects_pose,
-		_static_objects_pose, _camera_frame_buffers, verbose);
+		_static_objects_pose, _camera_frame_buffers, verbose, NULL,
+		&_tessellation_settings);
+	_world_id++;
 	_current_camera_index = 0;
 	for (auto it : _camera_frame_buffers) {
+		auto frame_buffer =
+			std::dynamic_pointer_cast<cCaptureFrameBuffer>(it.second);
+		if (frame_buffer == nullptr) {
+			throw std::runtime_error("frame buffer of camera " + it.first +
+									 " does not support image capture");
+		}
+		_camera_indices[it.first] = _cameras.size();
+		_cameras.push_back(CameraGraphicsData{it.first, frame_buffer});
 		_camera_names.push_back(it.first);
 	}
+	buildWorldIndex();
 	for (auto robot_filename : _robot_filenames) {
 		// get robot base object in chai world
-		cRobotBase* base = NULL;
-		for (unsigned int i = 0; i < _world->getNumChildren(); ++i) {
-			if (robot_filename.first == _world->getChild(i)->m_name) {
-				// cast to cRobotBase
-				base = dynamic_cast<cRobotBase*>(_world->getChild(i));
-				if (base != NULL) {
-					break;
-				}
-			}
-		}
+		cRobotBase* base = _robot_bases.at(robot_filename.first);
 		Eigen::Affine3d T_robot_base;
 		T_robot_base.translation() = base->getLocalPos().eigen();
 		T_robot_base.linear() = base->getLocalRot().eigen();
-		_robot_models[robot_filename.first] =
+		auto robot_model =
 			std::make_shared<SaiModel::SaiModel>(robot_filename.second);
-		_robot_models[robot_filename.first]->setTRobotBase(T_robot_base);
-		updateRobotGraphics(robot_filename.first,
-							_robot_models[robot_filename.first]->q());
+		robot_model->setTRobotBase(T_robot_base);
+		_robot_models[robot_filename.first] = robot_model;
+		_robot_indices[robot_filename.first] = _robots.size();
+		_robots.push_back(RobotGraphicsData{
+			robot_filename.first, robot_model, base,
+			Eigen::VectorXd::Zero(robot_model->dof())});
+		buildLinkUpdateOrder(_robots.back());
+		updateRobotGraphicsInternal(_robots.back(), robot_model->q(),
+									_robots.back().zero_dq);
+		// the publication buffers are sized here so that publishing does not
+		// allocate
+		RobotGraphicsData& robot = _robots.back();
+		const PublishedRobotState initial_state{robot_model->q(),
+												robot.zero_dq};
+		robot.published_state =
+			std::make_unique<TripleBuffer<PublishedRobotState>>(initial_state);
+		robot.previous_state = initial_state;
+		robot.latest_state = initial_state;
+		robot.interpolated_q = initial_state.joint_angles;
+		robot.interpolated_dq = initial_state.joint_velocities;
 	}
 	for (auto object_pose : _dyn_objects_pose) {
 		_object_velocities[object_pose.first] =
 			std::make_shared<Eigen::Vector6d>(Eigen::Vector6d::Zero());
-	}
+		_object_indices[object_pose.first] = _objects.size();
+		_objects.push_back(ObjectGraphicsData{
+			object_pose.first, _object_nodes.at(object_pose.first),
+			object_pose.second, _object_velocities.at(object_pose.first)});
+		_objects.back().culling_index =
+			_frustum_culler.addNode(_objects.back().object);
+		_frustum_culler.setNodePose(_objects.back().culling_index,
+									*object_pose.second);
+		const PublishedObjectState initial_state{*object_pose.second,
+												 Eigen::Vector6d::Zero()};
+		_objects.back().published_state =
+			std::make_unique<TripleBuffer<PublishedObjectState>>(initial_state);
+		_objects.back().previous_state = initial_state;
+		_objects.back().latest_state = initial_state;
+	}
+	// the static objects never move, their bounding spheres are placed once
+	for (const auto& object_pose : _static_objects_pose) {
+		_frustum_culler.setNodePose(
+			_frustum_culler.addNode(_object_nodes.at(object_pose.first)),
+			*object_pose.second);
+	}
+	buildSegmentationLabels();
 	_right_click_interaction_occurring = false;
+	_shadow_maps_dirty = true;
 }
 
 void SaiGraphics::clearWorld() {
@@ -240,10 +331,72 @@ void SaiGraphics::clearWorld() {
 	_camera_frame_buffers.clear();
 	_force_sensor_displays.clear();
 	_ui_force_widgets.clear();
+	_ui_torques_buffers.clear();
 	_camera_link_attachments.clear();
+	_robot_bases.clear();
+	_robot_links.clear();
+	_object_nodes.clear();
+	_robots.clear();
+	_robot_indices.clear();
+	_objects.clear();
+	_object_indices.clear();
+	_cameras.clear();
+	_camera_indices.clear();
+	_segmentation_pass.clear();
+	_frustum_culler.clear();
 }
 
-void SaiGraphics::initializeWindow(const std::string& window_name) {
+void SaiGraphics::buildWorldIndex() {
+	_robot_bases.clear();
+	_robot_links.clear();
+	_object_nodes.clear();
+	// single pass over the world children. If several children share a name,
+	// the first one is kept, as was the case with the linear lookups
+	for (unsigned int i = 0; i < _world->getNumChildren(); ++i) {
+		cGenericObject* child = _world->getChild(i);
+		const std::string& name = child->m_name;
+		cRobotBase* base = dynamic_cast<cRobotBase*>(child);
+		if (base != NULL) {
+			if (_robot_filenames.find(name) != _robot_filenames.end()) {
+				_robot_bases.emplace(name, base);
+			}
+		} else if (_dyn_objects_pose.find(name) != _dyn_objects_pose.end() ||
+				   _static_objects_pose.find(name) !=
+					   _static_objects_pose.end()) {
+			_object_nodes.emplace(name, child);
+		}
+	}
+	for (const auto& robot_filename : _robot_filenames) {
+		auto it = _robot_bases.find(robot_filename.first);
+		if (it == _robot_bases.end()) {
+			throw std::runtime_error("Could not find robot in chai world: " +
+									 robot_filename.first);
+		}
+		indexRobotLinksRecursive(it->second,
+								 _robot_links[robot_filename.first]);
+	}
+}
+
+void SaiGraphics::indexRobotLinksRecursive(
+	cGenericObject* parent,
+	std::unordered_map<std::string, cRobotLink*>& link_index) {
+	cRobotLink* child;
+	for (unsigned int i = 0; i < parent->getNumChildren(); ++i) {
+		child = dynamic_cast<cRobotLink*>(parent->getChild(i));
+		if (child != NULL) {
+			link_index.emplace(child->m_name, child);
+			indexRobotLinksRecursive(child, link_index);
+		}
+	}
+}
+
+void SaiGraphics::initializeWindow(const std::string& window_name,
+								   const bool headless) {
+	if (headless) {
+		_window = NULL;
+		_headless_context = std::make_unique<HeadlessContext>();
+		return;
+	}
 	_window = glfwInitialize(window_name);
 
 	// set callbacks
@@ -420,6 +573,82 @@ void SaiGraphics::updateDisplayedForceSensor(
 	}
 	_force_sensor_displays.at(sensor_index)
 		->update(force_data.force_world_frame, force_data.moment_world_frame);
+	_shadow_maps_dirty = true;
+}
+
+void SaiGraphics::updateDisplayedForceSensor(
+	const ForceSensorHandle& sensor, const Eigen::Vector3d& force_world_frame,
+	const Eigen::Vector3d& moment_world_frame) {
+	checkHandle(sensor, _force_sensor_displays.size(),
+				"SaiGraphics::updateDisplayedForceSensor");
+	_force_sensor_displays[sensor.index]->update(force_world_frame,
+												 moment_world_frame);
+	_shadow_maps_dirty = true;
+}
+
+RobotHandle SaiGraphics::getRobotHandle(const std::string& robot_name) const {
+	auto it = _robot_indices.find(robot_name);
+	if (it == _robot_indices.end()) {
+		throw std::invalid_argument("robot " + robot_name +
+									" not found in SaiGraphics::getRobotHandle");
+	}
+	RobotHandle handle;
+	handle.index = it->second;
+	handle.world_id = _world_id;
+	return handle;
+}
+
+ObjectHandle SaiGraphics::getObjectHandle(
+	const std::string& object_name) const {
+	auto it = _object_indices.find(object_name);
+	if (it == _object_indices.end()) {
+		throw std::invalid_argument(
+			"dynamic object " + object_name +
+			" not found in SaiGraphics::getObjectHandle");
+	}
+	ObjectHandle handle;
+	handle.index = it->second;
+	handle.world_id = _world_id;
+	return handle;
+}
+
+CameraHandle SaiGraphics::getCameraHandle(
+	const std::string& camera_name) const {
+	auto it = _camera_indices.find(camera_name);
+	if (it == _camera_indices.end()) {
+		throw std::invalid_argument(
+			"camera " + camera_name +
+			" not found in SaiGraphics::getCameraHandle");
+	}
+	CameraHandle handle;
+	handle.index = it->second;
+	handle.world_id = _world_id;
+	return handle;
+}
+
+ForceSensorHandle SaiGraphics::getForceSensorHandle(
+	const std::string& robot_or_object_name,
+	const std::string& link_name) const {
+	int sensor_index = findForceSensorDisplay(robot_or_object_name, link_name);
+	if (sensor_index == -1) {
+		throw std::invalid_argument(
+			"no force sensor on robot or object " + robot_or_object_name +
+			" on link " + link_name + " in SaiGraphics::getForceSensorHandle");
+	}
+	ForceSensorHandle handle;
+	handle.index = sensor_index;
+	handle.world_id = _world_id;
+	return handle;
+}
+
+void SaiGraphics::checkHandle(const GraphicsHandle& handle,
+							  const size_t num_elements,
+							  const std::string& function_name) const {
+	if (!handle.isValid() || handle.world_id != _world_id ||
+		handle.index >= num_elements) {
+		throw std::invalid_argument("invalid or outdated handle in " +
+									function_name);
+	}
 }
 
 bool SaiGraphics::robotExistsInWorld(const std::string& robot_name,
@@ -453,12 +682,7 @@ bool SaiGraphics::staticObjectExistsInWorld(
 }
 
 bool SaiGraphics::cameraExistsInWorld(const std::string& camera_name) const {
-	for (const std::string name : _camera_names) {
-		if (name == camera_name) {
-			return true;
-		}
-	}
-	return false;
+	return _camera_indices.find(camera_name) != _camera_indices.end();
 }
 
 int SaiGraphics::findForceSensorDisplay(
@@ -491,6 +715,7 @@ void SaiGraphics::addUIForceInteraction(
 	}
 	chai3d::cShapeLine* display_line = new chai3d::cShapeLine();
 	_world->addChild(display_line);
+	_shadow_maps_dirty = true;
 	if (is_robot) {
 		_ui_force_widgets.push_back(std::make_shared<UIForceWidget>(
 			robot_or_object_name, interact_at_object_center,
@@ -501,6 +726,11 @@ void SaiGraphics::addUIForceInteraction(
 			_dyn_objects_pose[robot_or_object_name],
 			_object_velocities[robot_or_object_name], display_line));
 	}
+	const int num_ui_torques =
+		is_robot ? _robot_models[robot_or_object_name]->dof() : 6;
+	_ui_torques_buffers.push_back(
+		std::make_unique<TripleBuffer<Eigen::VectorXd>>(
+			Eigen::VectorXd::Zero(num_ui_torques)));
 }
 
 Eigen::VectorXd SaiGraphics::getUITorques(
@@ -511,9 +741,15 @@ Eigen::VectorXd SaiGraphics::getUITorques(
 		throw std::invalid_argument(
 			"robot or dynamic object not found in SaiGraphics::getUITorques");
 	}
-	for (auto widget : _ui_force_widgets) {
-		if (robot_or_object_name == widget->getRobotOrObjectName()) {
-			return widget->getUIJointTorques();
+	for (int i = 0; i < _ui_force_widgets.size(); ++i) {
+		if (robot_or_object_name ==
+			_ui_force_widgets[i]->getRobotOrObjectName()) {
+			if (_render_loop_running) {
+				// the torques are computed by the render thread
+				_ui_torques_buffers[i]->fetch();
+				return _ui_torques_buffers[i]->readBuffer();
+			}
+			return _ui_force_widgets[i]->getUIJointTorques();
 		}
 	}
 	return is_robot ? Eigen::VectorXd::Zero(
@@ -538,6 +774,9 @@ const std::vector<std::string> SaiGraphics::getObjectNames() const {
 }
 
 void SaiGraphics::renderBlackScreen() {
+	if (_window == NULL) {
+		return;
+	}
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT);
 	glfwSwapBuffers(_window);
@@ -546,22 +785,564 @@ void SaiGraphics::renderBlackScreen() {
 
 cImagePtr SaiGraphics::getCameraImage(const std::string& camera_name,
 									   const int width, const int height) {
-	if (!cameraExistsInWorld(camera_name)) {
+	auto it = _camera_indices.find(camera_name);
+	if (it == _camera_indices.end()) {
 		cout << "WARNING: Camera [" << camera_name
 			 << "] does not exists in the graphics world. Cannot get image"
 			 << endl;
 		return cImage::create();
 	}
+	return getCameraImageInternal(_cameras[it->second], width, height);
+}
 
-	_world->updateShadowMaps();
-	_camera_frame_buffers.at(camera_name)->setSize(width, height);
-	_camera_frame_buffers.at(camera_name)->renderView();
+cImagePtr SaiGraphics::getCameraImage(const CameraHandle& camera,
+									   const int width, const int height) {
+	checkHandle(camera, _cameras.size(), "SaiGraphics::getCameraImage");
+	return getCameraImageInternal(_cameras[camera.index], width, height);
+}
+
+cImagePtr SaiGraphics::getCameraImageInternal(CameraGraphicsData& camera,
+											   const int width,
+											   const int height) {
+	renderCameraView(camera, width, height);
 	cImagePtr image = cImage::create();
-	_camera_frame_buffers.at(camera_name)->copyImageBuffer(image);
+	camera.frame_buffer->copyImageBuffer(image);
+	if (image->getFormat() == GL_RGBA &&
+		image->getType() == GL_UNSIGNED_BYTE) {
+		publishCameraFrame(camera, image->getData(),
+						   4 * (size_t)image->getWidth());
+	}
 	return image;
 }
 
+void SaiGraphics::renderCameraView(CameraGraphicsData& camera,
+								   const int width, const int height) {
+	updateShadowMapsIfNeeded();
+	// resizing the frame buffer reallocates its attachments
+	if (camera.frame_buffer->getWidth() != width ||
+		camera.frame_buffer->getHeight() != height) {
+		camera.frame_buffer->setSize(width, height);
+	}
+	// the culling starts after the shadow pass, so that the culled links and
+	// objects still cast shadows in the view
+	_frustum_culler.begin(getCamera(camera.name),
+						  _camera_indices.at(camera.name), width, height);
+	camera.frame_buffer->renderView();
+	_frustum_culler.end();
+}
+
+void SaiGraphics::getCameraImage(const CameraHandle& camera, cImagePtr image,
+								 const int width, const int height) {
+	checkHandle(camera, _cameras.size(), "SaiGraphics::getCameraImage");
+	if (image == nullptr) {
+		throw std::invalid_argument(
+			"null image given to SaiGraphics::getCameraImage");
+	}
+	CameraGraphicsData& camera_data = _cameras[camera.index];
+	renderCameraView(camera_data, width, height);
+	if (image->getWidth() != width || image->getHeight() != height ||
+		image->getFormat() != GL_RGBA ||
+		image->getType() != GL_UNSIGNED_BYTE) {
+		image->allocate(width, height, GL_RGBA, GL_UNSIGNED_BYTE);
+	}
+	readCameraPixels(camera_data, image->getData(), 4 * (size_t)width);
+	publishCameraFrame(camera_data, image->getData(), 4 * (size_t)width);
+}
+
+void SaiGraphics::getCameraImage(const std::string& camera_name,
+								 cImagePtr image, const int width,
+								 const int height) {
+	getCameraImage(getCameraHandle(camera_name), image, width, height);
+}
+
+void SaiGraphics::getCameraImage(const CameraHandle& camera,
+								 unsigned char* data, const int width,
+								 const int height, const size_t row_stride) {
+	checkHandle(camera, _cameras.size(), "SaiGraphics::getCameraImage");
+	const size_t stride = row_stride == 0 ? 4 * (size_t)width : row_stride;
+	if (data == NULL || stride < 4 * (size_t)width || stride % 4 != 0) {
+		throw std::invalid_argument(
+			"null data or invalid row stride in SaiGraphics::getCameraImage");
+	}
+	CameraGraphicsData& camera_data = _cameras[camera.index];
+	renderCameraView(camera_data, width, height);
+	readCameraPixels(camera_data, data, stride);
+	publishCameraFrame(camera_data, data, stride);
+}
+
+void SaiGraphics::getCameraDepth(const CameraHandle& camera,
+								 std::vector<float>& depth, const int width,
+								 const int height) {
+	checkHandle(camera, _cameras.size(), "SaiGraphics::getCameraDepth");
+	CameraGraphicsData& camera_data = _cameras[camera.index];
+	renderCameraView(camera_data, width, height);
+	readCameraDepth(camera_data, depth);
+}
+
+void SaiGraphics::getCameraDepth(const std::string& camera_name,
+								 std::vector<float>& depth, const int width,
+								 const int height) {
+	getCameraDepth(getCameraHandle(camera_name), depth, width, height);
+}
+
+void SaiGraphics::getCameraImageAndDepth(const CameraHandle& camera,
+										 cImagePtr image,
+										 std::vector<float>& depth,
+										 const int width, const int height) {
+	checkHandle(camera, _cameras.size(), "SaiGraphics::getCameraImageAndDepth");
+	if (image == nullptr) {
+		throw std::invalid_argument(
+			"null image given to SaiGraphics::getCameraImageAndDepth");
+	}
+	CameraGraphicsData& camera_data = _cameras[camera.index];
+	renderCameraView(camera_data, width, height);
+	if (image->getWidth() != width || image->getHeight() != height ||
+		image->getFormat() != GL_RGBA ||
+		image->getType() != GL_UNSIGNED_BYTE) {
+		image->allocate(width, height, GL_RGBA, GL_UNSIGNED_BYTE);
+	}
+	readCameraPixels(camera_data, image->getData(), 4 * (size_t)width);
+	readCameraDepth(camera_data, depth);
+	publishCameraFrame(camera_data, image->getData(), 4 * (size_t)width);
+}
+
+void SaiGraphics::getCameraPointCloud(const CameraHandle& camera,
+									  PointCloud& cloud,
+									  const PointCloudSettings& settings,
+									  const int width, const int height) {
+	checkHandle(camera, _cameras.size(), "SaiGraphics::getCameraPointCloud");
+	CameraGraphicsData& camera_data = _cameras[camera.index];
+	renderCameraView(camera_data, width, height);
+	readCameraDepth(camera_data, camera_data.depth_scratch);
+	if (settings.with_colors) {
+		camera_data.pixels_scratch.resize(4 * (size_t)width * height);
+		readCameraPixels(camera_data, camera_data.pixels_scratch.data(),
+						 4 * (size_t)width);
+	}
+	const Eigen::Affine3d transform = settings.world_frame
+										  ? getCameraPose(camera_data.name)
+										  : Eigen::Affine3d::Identity();
+	_point_cloud_generator.compute(
+		camera_data.depth_scratch.data(), camera_data.pixels_scratch.data(),
+		getCameraIntrinsics(camera_data.name, width, height), transform,
+		settings, cloud);
+}
+
+void SaiGraphics::getCameraPointCloud(const std::string& camera_name,
+									  PointCloud& cloud,
+									  const PointCloudSettings& settings,
+									  const int width, const int height) {
+	getCameraPointCloud(getCameraHandle(camera_name), cloud, settings, width,
+						height);
+}
+
+void SaiGraphics::getCameraSegmentation(const CameraHandle& camera,
+										std::vector<unsigned int>& ids,
+										const int width, const int height) {
+	checkHandle(camera, _cameras.size(), "SaiGraphics::getCameraSegmentation");
+	CameraGraphicsData& camera_data = _cameras[camera.index];
+	if (camera_data.frame_buffer->getWidth() != width ||
+		camera_data.frame_buffer->getHeight() != height) {
+		camera_data.frame_buffer->setSize(width, height);
+	}
+	// no shadows in this pass, so the shadow maps are not updated
+	cCamera* chai_camera = getCamera(camera_data.name);
+	_frustum_culler.begin(chai_camera, camera.index, width, height);
+	_segmentation_pass.begin(_world, chai_camera);
+	camera_data.frame_buffer->renderView();
+	_segmentation_pass.end();
+	_frustum_culler.end();
+
+	// the RGBA pixels are read directly in the id buffer, 4 bytes per id, and
+	// decoded in place
+	ids.resize((size_t)width * height);
+	unsigned char* pixels = reinterpret_cast<unsigned char*>(ids.data());
+	readCameraPixels(camera_data, pixels, 4 * (size_t)width);
+	for (size_t i = 0; i < ids.size(); ++i) {
+		ids[i] = decodeSegmentationId(pixels + 4 * i);
+	}
+}
+
+void SaiGraphics::getCameraSegmentation(const std::string& camera_name,
+										std::vector<unsigned int>& ids,
+										const int width, const int height) {
+	getCameraSegmentation(getCameraHandle(camera_name), ids, width, height);
+}
+
+void SaiGraphics::setLevelOfDetailMaxPixelError(const double max_pixel_error) {
+	if (max_pixel_error <= 0) {
+		throw std::invalid_argument(
+			"maximum pixel error should be positive in "
+			"SaiGraphics::setLevelOfDetailMaxPixelError");
+	}
+	_frustum_culler.setMaxPixelError(max_pixel_error);
+}
+
+void SaiGraphics::setTessellationSettings(
+	const Parser::TessellationSettings& tessellation) {
+	tessellation.validate();
+	_tessellation_settings = tessellation;
+}
+
+CameraIntrinsics SaiGraphics::getCameraIntrinsics(
+	const std::string& camera_name, const int width, const int height) {
+	cCamera* camera = getCamera(camera_name);
+	return computeCameraIntrinsics(
+		width, height, camera->getFieldViewAngleDeg(),
+		camera->getNearClippingPlane(), camera->getFarClippingPlane());
+}
+
+void SaiGraphics::setCameraClippingPlanes(const std::string& camera_name,
+										  const double near_plane,
+										  const double far_plane) {
+	if (near_plane <= 0 || far_plane <= near_plane) {
+		throw std::invalid_argument(
+			"clipping planes should verify 0 < near < far in "
+			"SaiGraphics::setCameraClippingPlanes");
+	}
+	getCamera(camera_name)->setClippingPlanes(near_plane, far_plane);
+}
+
+void SaiGraphics::setCameraFieldOfView(const std::string& camera_name,
+									   const double vertical_fov_deg) {
+	if (vertical_fov_deg <= 0 || vertical_fov_deg >= 180) {
+		throw std::invalid_argument(
+			"field of view should be between 0 and 180 degrees in "
+			"SaiGraphics::setCameraFieldOfView");
+	}
+	getCamera(camera_name)->setFieldViewAngleDeg(vertical_fov_deg);
+}
+
+void SaiGraphics::readCameraDepth(CameraGraphicsData& camera,
+								  std::vector<float>& depth) {
+	const int width = camera.frame_buffer->getWidth();
+	const int height = camera.frame_buffer->getHeight();
+	depth.resize((size_t)width * height);
+	camera.frame_buffer->bindForReading();
+	glReadPixels(0, 0, width, height, GL_DEPTH_COMPONENT, GL_FLOAT,
+				 depth.data());
+	cCaptureFrameBuffer::unbindForReading();
+	cCamera* chai_camera = getCamera(camera.name);
+	linearizeDepthBuffer(depth.data(), depth.size(),
+						 chai_camera->getNearClippingPlane(),
+						 chai_camera->getFarClippingPlane());
+}
+
+void SaiGraphics::readCameraPixels(CameraGraphicsData& camera,
+								   unsigned char* data,
+								   const size_t row_stride) {
+	camera.frame_buffer->bindForReading();
+	// rows of row_stride bytes, 4 bytes per pixel
+	glPixelStorei(GL_PACK_ROW_LENGTH, row_stride / 4);
+	glReadPixels(0, 0, camera.frame_buffer->getWidth(),
+				 camera.frame_buffer->getHeight(), GL_RGBA, GL_UNSIGNED_BYTE,
+				 data);
+	glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+	cCaptureFrameBuffer::unbindForReading();
+}
+
+void SaiGraphics::getCameraImages(const std::vector<CameraHandle>& cameras,
+								  std::vector<cImagePtr>& images,
+								  const std::vector<CameraImageSize>& sizes) {
+	if (sizes.size() > 1 && sizes.size() != cameras.size()) {
+		throw std::invalid_argument(
+			"number of image sizes inconsistent with number of cameras in "
+			"SaiGraphics::getCameraImages");
+	}
+	// each camera has a single buffer for the batched captures
+	std::vector<bool> camera_in_batch(_cameras.size(), false);
+	for (const auto& camera : cameras) {
+		checkHandle(camera, _cameras.size(), "SaiGraphics::getCameraImages");
+		if (camera_in_batch[camera.index]) {
+			throw std::invalid_argument(
+				"camera " + _cameras[camera.index].name +
+				" appears twice in SaiGraphics::getCameraImages");
+		}
+		camera_in_batch[camera.index] = true;
+	}
+	images.resize(cameras.size());
+
+	// a single shadow pass for all the cameras
+	updateShadowMapsIfNeeded();
+
+	// render all the cameras and queue the pixel transfers
+	std::vector<unsigned long long> request_ids(cameras.size());
+	for (int i = 0; i < cameras.size(); ++i) {
+		const CameraImageSize size =
+			sizes.empty() ? CameraImageSize()
+						  : (sizes.size() == 1 ? sizes[0] : sizes[i]);
+		CameraGraphicsData& camera_data = _cameras[cameras[i].index];
+		renderCameraView(camera_data, size.width, size.height);
+		if (!camera_data.batch_readback) {
+			camera_data.batch_readback = std::make_unique<AsyncReadback>(1);
+		}
+		request_ids[i] = _next_camera_image_request_id++;
+		camera_data.frame_buffer->bindForReading();
+		camera_data.batch_readback->startRead(
+			camera_data.frame_buffer->getWidth(),
+			camera_data.frame_buffer->getHeight(), request_ids[i]);
+		cCaptureFrameBuffer::unbindForReading();
+	}
+
+	// collect the images
+	for (int i = 0; i < cameras.size(); ++i) {
+		if (images[i] == nullptr) {
+			images[i] = cImage::create();
+		}
+		_cameras[cameras[i].index].batch_readback->collect(0, request_ids[i],
+														   images[i]);
+	}
+	// the published frames are copied from the collected images
+	for (int i = 0; i < cameras.size(); ++i) {
+		publishCameraFrame(_cameras[cameras[i].index], images[i]->getData(),
+						   4 * (size_t)images[i]->getWidth());
+	}
+}
+
+std::vector<cImagePtr> SaiGraphics::getCameraImages(
+	const std::vector<std::string>& camera_names,
+	const std::vector<CameraImageSize>& sizes) {
+	std::vector<CameraHandle> cameras;
+	cameras.reserve(camera_names.size());
+	for (const auto& camera_name : camera_names) {
+		cameras.push_back(getCameraHandle(camera_name));
+	}
+	std::vector<cImagePtr> images;
+	getCameraImages(cameras, images, sizes);
+	return images;
+}
+
+CameraImageTicket SaiGraphics::requestCameraImage(const CameraHandle& camera,
+												  const int width,
+												  const int height) {
+	checkHandle(camera, _cameras.size(), "SaiGraphics::requestCameraImage");
+	CameraGraphicsData& camera_data = _cameras[camera.index];
+	renderCameraView(camera_data, width, height);
+
+	if (!camera_data.readback) {
+		camera_data.readback =
+			std::make_unique<AsyncReadback>(_num_camera_readback_buffers);
+	}
+	CameraImageTicket ticket;
+	ticket.camera_index = camera.index;
+	ticket.world_id = _world_id;
+	ticket.request_id = _next_camera_image_request_id++;
+	camera_data.frame_buffer->bindForReading();
+	ticket.buffer_index =
+		camera_data.readback->startRead(camera_data.frame_buffer->getWidth(),
+										camera_data.frame_buffer->getHeight(),
+										ticket.request_id);
+	cCaptureFrameBuffer::unbindForReading();
+	return ticket;
+}
+
+CameraImageTicket SaiGraphics::requestCameraImage(
+	const std::string& camera_name, const int width, const int height) {
+	return requestCameraImage(getCameraHandle(camera_name), width, height);
+}
+
+bool SaiGraphics::isCameraImageReady(const CameraImageTicket& ticket) {
+	checkCameraImageTicket(ticket, "SaiGraphics::isCameraImageReady");
+	const auto& readback = _cameras[ticket.camera_index].readback;
+	return readback && readback->isReady(ticket.buffer_index,
+										 ticket.request_id);
+}
+
+cImagePtr SaiGraphics::getRequestedCameraImage(
+	const CameraImageTicket& ticket) {
+	cImagePtr image = cImage::create();
+	getRequestedCameraImage(ticket, image);
+	return image;
+}
+
+void SaiGraphics::getRequestedCameraImage(const CameraImageTicket& ticket,
+										  cImagePtr image) {
+	checkCameraImageTicket(ticket, "SaiGraphics::getRequestedCameraImage");
+	if (image == nullptr) {
+		throw std::invalid_argument(
+			"null image given to SaiGraphics::getRequestedCameraImage");
+	}
+	const auto& readback = _cameras[ticket.camera_index].readback;
+	if (!readback ||
+		!readback->collect(ticket.buffer_index, ticket.request_id, image)) {
+		throw std::invalid_argument(
+			"camera image request was dropped or already collected in "
+			"SaiGraphics::getRequestedCameraImage");
+	}
+}
+
+void SaiGraphics::setNumCameraReadbackBuffers(const unsigned int num_buffers) {
+	if (num_buffers == 0) {
+		throw std::invalid_argument(
+			"number of readback buffers should be at least 1 in "
+			"SaiGraphics::setNumCameraReadbackBuffers");
+	}
+	_num_camera_readback_buffers = num_buffers;
+	for (auto& camera : _cameras) {
+		camera.readback.reset();
+	}
+}
+
+void SaiGraphics::startRecording(const std::string& camera_name,
+								 const std::string& path, const double fps,
+								 const VideoRecorder::Format format,
+								 const int width, const int height) {
+	CameraGraphicsData& camera = _cameras[getCameraHandle(camera_name).index];
+	// stop the previous recording first so that it releases its file
+	camera.recorder.reset();
+	camera.recorder = std::make_unique<VideoRecorder>(path, width, height,
+													  fps, format);
+	camera.next_recording_time = steadyClockTime();
+}
+
+VideoRecorder::Statistics SaiGraphics::stopRecording(
+	const std::string& camera_name) {
+	CameraGraphicsData& camera = _cameras[getCameraHandle(camera_name).index];
+	if (!camera.recorder) {
+		cout << "WARNING: camera [" << camera_name
+			 << "] is not being recorded in SaiGraphics::stopRecording" << endl;
+		return VideoRecorder::Statistics();
+	}
+	camera.recorder->stop();
+	const VideoRecorder::Statistics statistics =
+		camera.recorder->getStatistics();
+	camera.recorder.reset();
+	return statistics;
+}
+
+bool SaiGraphics::isRecording(const std::string& camera_name) {
+	return _cameras[getCameraHandle(camera_name).index].recorder != nullptr;
+}
+
+VideoRecorder::Statistics SaiGraphics::getRecordingStatistics(
+	const std::string& camera_name) {
+	const auto& recorder =
+		_cameras[getCameraHandle(camera_name).index].recorder;
+	return recorder ? recorder->getStatistics() : VideoRecorder::Statistics();
+}
+
+void SaiGraphics::publishCameraFrames(const std::string& camera_name,
+									  const std::string& shared_memory_name,
+									  const unsigned int num_slots,
+									  const int max_width,
+									  const int max_height) {
+	CameraGraphicsData& camera = _cameras[getCameraHandle(camera_name).index];
+	// release the previous segment first, it may have the same name
+	camera.frame_publisher.reset();
+	camera.frame_publisher = std::make_unique<SharedFrameWriter>(
+		shared_memory_name, num_slots, 4 * (size_t)max_width * max_height);
+}
+
+void SaiGraphics::stopPublishingCameraFrames(const std::string& camera_name) {
+	_cameras[getCameraHandle(camera_name).index].frame_publisher.reset();
+}
+
+void SaiGraphics::publishWindowFrames(const std::string& shared_memory_name,
+									  const unsigned int num_slots,
+									  const int max_width,
+									  const int max_height) {
+	if (_window == NULL) {
+		throw std::runtime_error(
+			"SaiGraphics::publishWindowFrames is not available in headless "
+			"mode");
+	}
+	_window_frame_publisher.reset();
+	_window_frame_publisher = std::make_unique<SharedFrameWriter>(
+		shared_memory_name, num_slots, 4 * (size_t)max_width * max_height);
+}
+
+void SaiGraphics::stopPublishingWindowFrames() {
+	_window_frame_publisher.reset();
+}
+
+void SaiGraphics::publishCameraFrame(CameraGraphicsData& camera,
+									 const unsigned char* pixels,
+									 const size_t row_stride) {
+	if (!camera.frame_publisher) {
+		return;
+	}
+	const int width = camera.frame_buffer->getWidth();
+	const int height = camera.frame_buffer->getHeight();
+	unsigned char* data = camera.frame_publisher->beginFrame(
+		width, height, SharedFrameInfo::RGBA8, _simulation_time);
+	// frames larger than the slots are not published
+	if (data == NULL) {
+		return;
+	}
+	// the pixels were already read by the capture, they are only copied
+	const size_t frame_row_size = 4 * (size_t)width;
+	for (int row = 0; row < height; ++row) {
+		memcpy(data + row * frame_row_size, pixels + row * row_stride,
+			   frame_row_size);
+	}
+	camera.frame_publisher->endFrame();
+}
+
+void SaiGraphics::publishWindowFrame() {
+	if (!_window_frame_publisher) {
+		return;
+	}
+	unsigned char* data = _window_frame_publisher->beginFrame(
+		_window_width, _window_height, SharedFrameInfo::RGBA8,
+		_simulation_time);
+	if (data == NULL) {
+		return;
+	}
+	// the frame was rendered in the back buffer, swapped at the next render
+	glReadBuffer(GL_BACK);
+	glReadPixels(0, 0, _window_width, _window_height, GL_RGBA,
+				 GL_UNSIGNED_BYTE, data);
+	_window_frame_publisher->endFrame();
+}
+
+void SaiGraphics::recordCameraFrames() {
+	double now = 0.0;
+	for (auto& camera : _cameras) {
+		if (!camera.recorder) {
+			continue;
+		}
+		if (now == 0.0) {
+			now = steadyClockTime();
+		}
+		if (now < camera.next_recording_time) {
+			continue;
+		}
+		// if the rendering was too slow, restart the schedule from now
+		// instead of capturing several frames in a row
+		const double period = 1.0 / camera.recorder->fps();
+		camera.next_recording_time += period;
+		if (camera.next_recording_time < now) {
+			camera.next_recording_time = now + period;
+		}
+		// nothing is rendered if the frame would be dropped
+		unsigned char* frame = camera.recorder->acquireFrame();
+		if (frame == NULL) {
+			continue;
+		}
+		renderCameraView(camera, camera.recorder->width(),
+						 camera.recorder->height());
+		readCameraPixels(camera, frame, 4 * (size_t)camera.recorder->width());
+		camera.recorder->submitFrame();
+	}
+}
+
+void SaiGraphics::checkCameraImageTicket(
+	const CameraImageTicket& ticket, const std::string& function_name) const {
+	if (!ticket.isValid() || ticket.world_id != _world_id ||
+		ticket.camera_index >= _cameras.size()) {
+		throw std::invalid_argument(
+			"invalid or outdated camera image ticket in " + function_name);
+	}
+}
+
 void SaiGraphics::renderGraphicsWorld() {
+	// apply the states published from other threads
+	applyPublishedStates();
+	recordCameraFrames();
+	if (_window == NULL) {
+		return;
+	}
+
 	// swap camera if needed
 	if (consume_first_press(NEXT_CAMERA_KEY)) {
 		_current_camera_index =
@@ -604,6 +1385,10 @@ void SaiGraphics::renderGraphicsWorld() {
 
 	// 1 - mouse right button to generate a force/torque
 	if (is_pressed(GLFW_MOUSE_BUTTON_RIGHT)) {
+		// the widget display lines move with the cursor
+		if (!_ui_force_widgets.empty()) {
+			_shadow_maps_dirty = true;
+		}
 		if (consume_first_press(GLFW_MOUSE_BUTTON_RIGHT)) {
 			for (auto widget : _ui_force_widgets) {
 				widget->setEnable(true);
@@ -641,6 +1426,9 @@ void SaiGraphics::renderGraphicsWorld() {
 										 _window_height, depth_change);
 		}
 	} else {
+		if (_right_click_interaction_occurring) {
+			_shadow_maps_dirty = true;
+		}
 		for (auto widget : _ui_force_widgets) {
 			widget->setEnable(false);
 		}
@@ -750,80 +1538,177 @@ void SaiGraphics::renderGraphicsWorld() {
 	}
 
 	// update shadow maps
-	_world->updateShadowMaps();
+	updateShadowMapsIfNeeded();
 
 	render(camera_name);
+	publishWindowFrame();
 }
 
-static void updateGraphicsLink(
-	cRobotLink* link, std::shared_ptr<SaiModel::SaiModel> robot_model) {
-	cVector3d local_pos;
-	cMatrix3d local_rot;
-
-	// get link name
-	std::string link_name = link->m_name;
-
-	// get chai parent name
-	cGenericObject* parent = link->getParent();
-	std::string parent_name = parent->m_name;
-
-	// if parent is cRobotBase, then simply get transform relative to base from
-	// model
-	if (dynamic_cast<cRobotBase*>(parent) != NULL) {
-		Eigen::Affine3d T = robot_model->transform(link_name);
-		local_pos = cVector3d(T.translation());
-		local_rot = cMatrix3d(T.rotation());
-	} else if (dynamic_cast<cRobotLink*>(parent) != NULL) {
-		// if parent is cRobotLink, then calculate transform for both links,
-		// then apply inverse transform
-		Eigen::Affine3d T_me, T_parent, T_rel;
-		T_me = robot_model->transform(link_name);
-		T_parent = robot_model->transform(parent_name);
-		T_rel = T_parent.inverse() * T_me;
-		local_pos = cVector3d(T_rel.translation());
-		local_rot = cMatrix3d(T_rel.rotation());
-	} else {
-		cerr << "Parent to link " << link_name << " is neither link nor base"
-			 << endl;
-		abort();
-		// TODO: throw exception
+void SaiGraphics::runRenderLoop(const double target_fps) {
+	if (_window == NULL) {
+		throw std::runtime_error(
+			"SaiGraphics::runRenderLoop is not available in headless mode");
 	}
-	link->setLocalPos(local_pos);
-	link->setLocalRot(local_rot);
+	if (target_fps <= 0) {
+		throw std::invalid_argument(
+			"target frame rate should be positive in "
+			"SaiGraphics::runRenderLoop");
+	}
+	const auto frame_period =
+		std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::duration<double>(1.0 / target_fps));
+
+	// the loop paces itself, don't wait for the vertical sync in the swap
+	glfwSwapInterval(0);
+	_render_loop_stop_requested = false;
+	_render_loop_running = true;
+
+	auto next_frame_time = std::chrono::steady_clock::now();
+	while (isWindowOpen() && !_render_loop_stop_requested) {
+		renderGraphicsWorld();
+
+		// make the ui torques available to the application thread
+		for (int i = 0; i < _ui_force_widgets.size(); ++i) {
+			_ui_torques_buffers[i]->writeBuffer() =
+				_ui_force_widgets[i]->getUIJointTorques();
+			_ui_torques_buffers[i]->publish();
+		}
 
-	// call on children
-	cRobotLink* child;
-	for (unsigned int i = 0; i < link->getNumChildren(); ++i) {
-		child = dynamic_cast<cRobotLink*>(link->getChild(i));
-		if (child != NULL) {
-			updateGraphicsLink(child, robot_model);
+		next_frame_time += frame_period;
+		const auto now = std::chrono::steady_clock::now();
+		if (next_frame_time < now) {
+			// the frame took too long, don't try to catch up
+			next_frame_time = now;
+		} else {
+			std::this_thread::sleep_until(next_frame_time);
 		}
 	}
+
+	_render_loop_running = false;
+	glfwSwapInterval(1);
+}
+
+void SaiGraphics::updateShadowMapsIfNeeded() {
+	// the shadow maps only depend on the lights and on the shadow casters, not
+	// on the camera used for rendering
+	if (_shadow_maps_dirty.exchange(false)) {
+		_world->updateShadowMaps();
+	}
 }
 
 // update frame for a particular robot
 void SaiGraphics::updateRobotGraphics(const std::string& robot_name,
 									   const Eigen::VectorXd& joint_angles) {
-	auto it = _robot_models.find(robot_name);
-	if (it == _robot_models.end()) {
+	auto it = _robot_indices.find(robot_name);
+	if (it == _robot_indices.end()) {
 		throw std::invalid_argument(
 			"Robot not found in SaiGraphics::updateRobotGraphics");
 	}
-	updateRobotGraphics(
-		robot_name, joint_angles,
-		Eigen::VectorXd::Zero(_robot_models.at(robot_name)->dof()));
+	RobotGraphicsData& robot = _robots[it->second];
+	updateRobotGraphicsInternal(robot, joint_angles, robot.zero_dq);
 }
 
 void SaiGraphics::updateRobotGraphics(
 	const std::string& robot_name, const Eigen::VectorXd& joint_angles,
 	const Eigen::VectorXd& joint_velocities) {
-	// update corresponfing robot model
-	auto it = _robot_models.find(robot_name);
-	if (it == _robot_models.end()) {
+	auto it = _robot_indices.find(robot_name);
+	if (it == _robot_indices.end()) {
 		throw std::invalid_argument(
 			"Robot not found in SaiGraphics::updateRobotGraphics");
 	}
-	auto robot_model = _robot_models.at(robot_name);
+	updateRobotGraphicsInternal(_robots[it->second], joint_angles,
+								joint_velocities);
+}
+
+void SaiGraphics::updateRobotGraphics(const RobotHandle& robot,
+									   const Eigen::VectorXd& joint_angles) {
+	checkHandle(robot, _robots.size(), "SaiGraphics::updateRobotGraphics");
+	updateRobotGraphicsInternal(_robots[robot.index], joint_angles,
+								_robots[robot.index].zero_dq);
+}
+
+void SaiGraphics::updateRobotGraphics(
+	const RobotHandle& robot, const Eigen::VectorXd& joint_angles,
+	const Eigen::VectorXd& joint_velocities) {
+	checkHandle(robot, _robots.size(), "SaiGraphics::updateRobotGraphics");
+	updateRobotGraphicsInternal(_robots[robot.index], joint_angles,
+								joint_velocities);
+}
+
+void SaiGraphics::updateRobotsGraphics(
+	const std::vector<RobotHandle>& robots,
+	const std::vector<Eigen::VectorXd>& joint_angles,
+	const std::vector<Eigen::VectorXd>& joint_velocities) {
+	if (joint_angles.size() != robots.size()) {
+		throw std::invalid_argument(
+			"number of joint angle vectors inconsistent with number of robots "
+			"in SaiGraphics::updateRobotsGraphics");
+	}
+	if (!joint_velocities.empty() &&
+		joint_velocities.size() != robots.size()) {
+		throw std::invalid_argument(
+			"number of joint velocity vectors inconsistent with number of "
+			"robots in SaiGraphics::updateRobotsGraphics");
+	}
+	// validate the handles serially, each robot must only be updated by one
+	// thread
+	std::vector<bool> robot_in_batch(_robots.size(), false);
+	for (const auto& robot : robots) {
+		checkHandle(robot, _robots.size(), "SaiGraphics::updateRobotsGraphics");
+		if (robot_in_batch[robot.index]) {
+			throw std::invalid_argument(
+				"robot " + _robots[robot.index].name +
+				" appears twice in SaiGraphics::updateRobotsGraphics");
+		}
+		robot_in_batch[robot.index] = true;
+	}
+
+	if (!_update_thread_pool) {
+		_update_thread_pool = std::make_unique<ThreadPool>();
+	}
+	// the per robot update only writes to the robot model and to the local
+	// transforms of the chai links, no OpenGL calls are made
+	_update_thread_pool->parallelFor(robots.size(), [&](size_t i) {
+		RobotGraphicsData& robot = _robots[robots[i].index];
+		updateRobotGraphicsInternal(
+			robot, joint_angles[i],
+			joint_velocities.empty() ? robot.zero_dq : joint_velocities[i]);
+	});
+}
+
+void SaiGraphics::setUpdateTolerance(const double tolerance) {
+	if (tolerance < 0) {
+		throw std::invalid_argument(
+			"update tolerance should be non negative in "
+			"SaiGraphics::setUpdateTolerance");
+	}
+	_update_tolerance = tolerance;
+}
+
+unsigned int SaiGraphics::getNumUpdateThreads() const {
+	if (_update_thread_pool) {
+		return _update_thread_pool->numThreads();
+	}
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void SaiGraphics::updateRobotsGraphics(
+	const std::vector<std::string>& robot_names,
+	const std::vector<Eigen::VectorXd>& joint_angles,
+	const std::vector<Eigen::VectorXd>& joint_velocities) {
+	std::vector<RobotHandle> robots;
+	robots.reserve(robot_names.size());
+	for (const auto& robot_name : robot_names) {
+		robots.push_back(getRobotHandle(robot_name));
+	}
+	updateRobotsGraphics(robots, joint_angles, joint_velocities);
+}
+
+void SaiGraphics::updateRobotGraphicsInternal(
+	RobotGraphicsData& robot, const Eigen::VectorXd& joint_angles,
+	const Eigen::VectorXd& joint_velocities) {
+	// update corresponfing robot model
+	auto& robot_model = robot.model;
 	if (joint_angles.size() != robot_model->qSize()) {
 		throw std::invalid_argument(
 			"size of joint angles inconsistent with robot model in "
@@ -834,64 +1719,260 @@ void SaiGraphics::updateRobotGraphics(
 			"size of joint velocities inconsistent with robot model in "
 			"SaiGraphics::updateRobotGraphics");
 	}
+	// skip the kinematics and the link update if the state did not change
+	if (!robot.needs_update &&
+		isWithinTolerance(joint_angles, robot_model->q(), _update_tolerance) &&
+		isWithinTolerance(joint_velocities, robot_model->dq(),
+						  _update_tolerance)) {
+		return;
+	}
+	robot.needs_update = false;
+	_shadow_maps_dirty = true;
+
 	robot_model->setQ(joint_angles);
 	robot_model->setDq(joint_velocities);
 	robot_model->updateKinematics();
 
-	// get robot base object in chai world
-	cRobotBase* base = NULL;
-	for (unsigned int i = 0; i < _world->getNumChildren(); ++i) {
-		if (robot_name == _world->getChild(i)->m_name) {
-			// cast to cRobotBase
-			base = dynamic_cast<cRobotBase*>(_world->getChild(i));
-			if (base != NULL) {
-				break;
-			}
+	// update the local pose of the links, parents first. The transform of
+	// each link is computed only once and reused by its children
+	Eigen::Affine3d T_world_base;
+	T_world_base.translation() = robot.base->getLocalPos().eigen();
+	T_world_base.linear() = robot.base->getLocalRot().eigen();
+	for (unsigned int i = 0; i < robot.links.size(); ++i) {
+		const RobotLinkGraphicsData& link_data = robot.links[i];
+		Eigen::Affine3d& T_base_link = robot.link_transforms[i];
+		T_base_link = robot_model->transform(link_data.link_name);
+		if (link_data.parent_index < 0) {
+			// parent is the robot base, use the transform relative to base
+			link_data.link->setLocalPos(cVector3d(T_base_link.translation()));
+			link_data.link->setLocalRot(cMatrix3d(T_base_link.linear()));
+		} else {
+			// parent is a link, express the transform in the parent frame
+			const Eigen::Affine3d& T_base_parent =
+				robot.link_transforms[link_data.parent_index];
+			const Eigen::Matrix3d R_parent_base =
+				T_base_parent.linear().transpose();
+			link_data.link->setLocalPos(
+				cVector3d(R_parent_base * (T_base_link.translation() -
+										   T_base_parent.translation())));
+			link_data.link->setLocalRot(
+				cMatrix3d(R_parent_base * T_base_link.linear()));
 		}
+		_frustum_culler.setNodePose(link_data.culling_index,
+									T_world_base * T_base_link);
 	}
-	if (base == NULL) {
-		// TODO: throw exception
-		cerr << "Could not find robot in chai world: " << robot_name << endl;
-		abort();
-	}
-	// recursively update graphics for all children
-	cRobotLink* link;
-	for (unsigned int i = 0; i < base->getNumChildren(); ++i) {
-		link = dynamic_cast<cRobotLink*>(base->getChild(i));
-		if (link != NULL) {
-			updateGraphicsLink(link, robot_model);
+}
+
+void SaiGraphics::buildLinkUpdateOrder(RobotGraphicsData& robot) {
+	robot.links.clear();
+	buildLinkUpdateOrderRecursive(robot, robot.base, -1);
+	robot.link_transforms.assign(robot.links.size(),
+								 Eigen::Affine3d::Identity());
+}
+
+void SaiGraphics::buildLinkUpdateOrderRecursive(RobotGraphicsData& robot,
+												 cGenericObject* parent,
+												 const int parent_index) {
+	cRobotLink* child;
+	for (unsigned int i = 0; i < parent->getNumChildren(); ++i) {
+		child = dynamic_cast<cRobotLink*>(parent->getChild(i));
+		if (child != NULL) {
+			const int child_index = robot.links.size();
+			robot.links.push_back(
+				RobotLinkGraphicsData{child, parent_index, child->m_name,
+									  _frustum_culler.addNode(child)});
+			buildLinkUpdateOrderRecursive(robot, child, child_index);
+		}
+	}
+}
+
+void SaiGraphics::buildSegmentationLabels() {
+	_segmentation_pass.clear();
+	for (const auto& robot : _robots) {
+		for (const auto& link : robot.links) {
+			_segmentation_pass.addLabel(
+				link.link, SegmentationLabel{robot.name, link.link_name, true});
 		}
 	}
+	// std::map iteration keeps the ids stable across runs
+	for (const auto& object_pose : _dyn_objects_pose) {
+		_segmentation_pass.addLabel(_object_nodes.at(object_pose.first),
+									SegmentationLabel{object_pose.first});
+	}
+	for (const auto& object_pose : _static_objects_pose) {
+		_segmentation_pass.addLabel(_object_nodes.at(object_pose.first),
+									SegmentationLabel{object_pose.first});
+	}
 }
 
 void SaiGraphics::updateObjectGraphics(
 	const std::string& object_name, const Eigen::Affine3d& object_pose,
 	const Eigen::Vector6d& object_velocity) {
-	if (!dynamicObjectExistsInWorld(object_name)) {
+	auto it = _object_indices.find(object_name);
+	if (it == _object_indices.end()) {
 		throw std::invalid_argument(
 			"dynamic object not found in SaiGraphics::updateObjectGraphics");
 	}
-	cGenericObject* object = NULL;
-	for (unsigned int i = 0; i < _world->getNumChildren(); ++i) {
-		if (object_name == _world->getChild(i)->m_name) {
-			// cast to cRobotBase
-			object = _world->getChild(i);
-			if (object != NULL) {
-				break;
+	updateObjectGraphicsInternal(_objects[it->second], object_pose,
+								 object_velocity);
+}
+
+void SaiGraphics::updateObjectGraphics(const ObjectHandle& object,
+										const Eigen::Affine3d& object_pose,
+										const Eigen::Vector6d& object_velocity) {
+	checkHandle(object, _objects.size(), "SaiGraphics::updateObjectGraphics");
+	updateObjectGraphicsInternal(_objects[object.index], object_pose,
+								 object_velocity);
+}
+
+void SaiGraphics::updateObjectGraphicsInternal(
+	ObjectGraphicsData& object, const Eigen::Affine3d& object_pose,
+	const Eigen::Vector6d& object_velocity) {
+	// the velocity is only used by the ui widgets, always keep it up to date
+	*object.velocity = object_velocity;
+	if (isWithinTolerance(object_pose.matrix(), object.pose->matrix(),
+						  _update_tolerance)) {
+		return;
+	}
+	// update pose
+	*object.pose = object_pose;
+	object.object->setLocalPos(object_pose.translation());
+	object.object->setLocalRot(object_pose.rotation());
+	_frustum_culler.setNodePose(object.culling_index, object_pose);
+	_shadow_maps_dirty = true;
+}
+
+void SaiGraphics::publishRobotState(const RobotHandle& robot,
+									const Eigen::VectorXd& joint_angles,
+									const Eigen::VectorXd& joint_velocities) {
+	checkHandle(robot, _robots.size(), "SaiGraphics::publishRobotState");
+	const RobotGraphicsData& robot_data = _robots[robot.index];
+	if (joint_angles.size() != robot_data.model->qSize()) {
+		throw std::invalid_argument(
+			"size of joint angles inconsistent with robot model in "
+			"SaiGraphics::publishRobotState");
+	}
+	if (joint_velocities.size() != robot_data.zero_dq.size()) {
+		throw std::invalid_argument(
+			"size of joint velocities inconsistent with robot model in "
+			"SaiGraphics::publishRobotState");
+	}
+	PublishedRobotState& state = robot_data.published_state->writeBuffer();
+	state.joint_angles = joint_angles;
+	state.joint_velocities = joint_velocities;
+	state.timestamp = steadyClockTime();
+	robot_data.published_state->publish();
+}
+
+void SaiGraphics::publishRobotState(const RobotHandle& robot,
+									const Eigen::VectorXd& joint_angles) {
+	checkHandle(robot, _robots.size(), "SaiGraphics::publishRobotState");
+	publishRobotState(robot, joint_angles, _robots[robot.index].zero_dq);
+}
+
+void SaiGraphics::publishObjectState(const ObjectHandle& object,
+									 const Eigen::Affine3d& object_pose,
+									 const Eigen::Vector6d& object_velocity) {
+	checkHandle(object, _objects.size(), "SaiGraphics::publishObjectState");
+	const ObjectGraphicsData& object_data = _objects[object.index];
+	PublishedObjectState& state = object_data.published_state->writeBuffer();
+	state.pose = object_pose;
+	state.velocity = object_velocity;
+	state.timestamp = steadyClockTime();
+	object_data.published_state->publish();
+}
+
+void SaiGraphics::applyPublishedStates() {
+	const double current_time = steadyClockTime();
+	for (auto& robot : _robots) {
+		const bool new_state = robot.published_state->fetch();
+		if (new_state) {
+			// the buffers have the same sizes, this does not allocate
+			std::swap(robot.previous_state, robot.latest_state);
+			robot.latest_state = robot.published_state->readBuffer();
+			robot.num_fetched_states = std::min(robot.num_fetched_states + 1, 2);
+		}
+		// quaternion coordinates of spherical joints can't be interpolated
+		// linearly, use the latest state for these robots
+		if (!_state_interpolation_enabled || robot.num_fetched_states < 2 ||
+			robot.model->qSize() != robot.model->dof()) {
+			if (new_state) {
+				updateRobotGraphicsInternal(robot,
+											robot.latest_state.joint_angles,
+											robot.latest_state.joint_velocities);
+			}
+			continue;
+		}
+		const double alpha = interpolationFactor(
+			robot.previous_state.timestamp, robot.latest_state.timestamp,
+			current_time);
+		const PublishedRobotState& s0 = robot.previous_state;
+		const PublishedRobotState& s1 = robot.latest_state;
+		robot.interpolated_q =
+			s0.joint_angles + alpha * (s1.joint_angles - s0.joint_angles);
+		robot.interpolated_dq =
+			s0.joint_velocities +
+			alpha * (s1.joint_velocities - s0.joint_velocities);
+		updateRobotGraphicsInternal(robot, robot.interpolated_q,
+									robot.interpolated_dq);
+	}
+	for (auto& object : _objects) {
+		const bool new_state = object.published_state->fetch();
+		if (new_state) {
+			object.previous_state = object.latest_state;
+			object.latest_state = object.published_state->readBuffer();
+			object.num_fetched_states =
+				std::min(object.num_fetched_states + 1, 2);
+		}
+		if (!_state_interpolation_enabled || object.num_fetched_states < 2) {
+			if (new_state) {
+				updateObjectGraphicsInternal(object, object.latest_state.pose,
+											 object.latest_state.velocity);
 			}
+			continue;
 		}
+		const double alpha = interpolationFactor(
+			object.previous_state.timestamp, object.latest_state.timestamp,
+			current_time);
+		const PublishedObjectState& s0 = object.previous_state;
+		const PublishedObjectState& s1 = object.latest_state;
+		Eigen::Affine3d pose = Eigen::Affine3d::Identity();
+		pose.translation() =
+			s0.pose.translation() +
+			alpha * (s1.pose.translation() - s0.pose.translation());
+		const Eigen::Quaterniond q0(s0.pose.rotation());
+		const Eigen::Quaterniond q1(s1.pose.rotation());
+		pose.linear() = q0.slerp(alpha, q1).toRotationMatrix();
+		const Eigen::Vector6d velocity =
+			s0.velocity + alpha * (s1.velocity - s0.velocity);
+		updateObjectGraphicsInternal(object, pose, velocity);
 	}
-	if (object == NULL) {
-		// TODO: throw exception
-		cerr << "Could not find object in chai world: " << object_name << endl;
-		abort();
+}
+
+void SaiGraphics::setStateInterpolation(const bool enabled,
+										const double max_extrapolation_time) {
+	if (max_extrapolation_time < 0) {
+		throw std::invalid_argument(
+			"max extrapolation time should be non negative in "
+			"SaiGraphics::setStateInterpolation");
 	}
+	_state_interpolation_enabled = enabled;
+	_max_extrapolation_time = max_extrapolation_time;
+}
 
-	// update pose
-	*_dyn_objects_pose.at(object_name) = object_pose;
-	*_object_velocities.at(object_name) = object_velocity;
-	object->setLocalPos(object_pose.translation());
-	object->setLocalRot(object_pose.rotation());
+double SaiGraphics::interpolationFactor(const double previous_timestamp,
+										const double latest_timestamp,
+										const double current_time) const {
+	const double interval = latest_timestamp - previous_timestamp;
+	if (interval <= 0) {
+		return 1.0;
+	}
+	// the states are displayed one publication interval late, so that the
+	// previous state is shown when the latest one arrives and the latest one
+	// is reached when the next one is expected
+	const double alpha = (current_time - latest_timestamp) / interval;
+	const double max_alpha = 1.0 + _max_extrapolation_time / interval;
+	return std::min(std::max(alpha, 0.0), max_alpha);
 }
 
 Eigen::VectorXd SaiGraphics::getRobotJointPos(const std::string& robot_name) {
@@ -919,7 +2000,10 @@ void SaiGraphics::render(const std::string& camera_name) {
 	// render view from this camera
 	// NOTE: we don't use the display context id right now since chai no longer
 	// supports it in 3.2.0
+	_frustum_culler.begin(camera, _camera_indices.at(camera_name),
+						  _window_width, _window_height);
 	camera->renderView(_window_width, _window_height);
+	_frustum_culler.end();
 }
 
 // get current camera pose
@@ -952,71 +2036,41 @@ void SaiGraphics::setCameraPoseInternal(const std::string& camera_name,
 
 // get camera object
 cCamera* SaiGraphics::getCamera(const std::string& camera_name) {
-	if (!cameraExistsInWorld(camera_name)) {
+	auto it = _camera_indices.find(camera_name);
+	if (it == _camera_indices.end()) {
 		throw std::invalid_argument(
 			"camera not found in SaiGraphics::getCamera");
 	}
-	return _camera_frame_buffers.at(camera_name)->getCamera();
+	return _cameras[it->second].frame_buffer->getCamera();
 }
 
-cRobotLink* SaiGraphics::findLinkObjectInParentLinkRecursive(
-	cRobotLink* parent, const std::string& link_name) {
-	// call on children
-	cRobotLink* child;
-	cRobotLink* ret_link = NULL;
-	for (unsigned int i = 0; i < parent->getNumChildren(); ++i) {
-		child = dynamic_cast<cRobotLink*>(parent->getChild(i));
-		if (child != NULL) {
-			if (child->m_name == link_name) {
-				ret_link = child;
-				break;
-			} else {
-				ret_link =
-					findLinkObjectInParentLinkRecursive(child, link_name);
-			}
-		}
+cGenericObject* SaiGraphics::findRobotOrObject(
+	const std::string& robot_or_object_name) const {
+	auto robot_it = _robot_bases.find(robot_or_object_name);
+	if (robot_it != _robot_bases.end()) {
+		return robot_it->second;
+	}
+	auto object_it = _object_nodes.find(robot_or_object_name);
+	if (object_it != _object_nodes.end()) {
+		return object_it->second;
 	}
-	return ret_link;
+	return NULL;
 }
 
 cRobotLink* SaiGraphics::findLink(const std::string& robot_name,
 								   const std::string& link_name) {
-	// get robot base
-	cRobotBase* base = NULL;
-	for (unsigned int i = 0; i < _world->getNumChildren(); ++i) {
-		if (robot_name == _world->getChild(i)->m_name) {
-			// cast to cRobotBase
-			base = dynamic_cast<cRobotBase*>(_world->getChild(i));
-			if (base != NULL) {
-				break;
-			}
-		}
-	}
-	if (base == NULL) {
-		// TODO: throw exception
-		cerr << "Could not find robot in chai world: " << robot_name << endl;
-		abort();
-	}
-
-	cRobotLink* target_link = NULL;
-	// get target link
-	cRobotLink* base_link;
-	for (unsigned int i = 0; i < base->getNumChildren(); ++i) {
-		base_link = dynamic_cast<cRobotLink*>(base->getChild(i));
-		if (base_link != NULL) {
-			if (base_link->m_name == link_name) {
-				target_link = base_link;
-				break;
-			} else {
-				target_link =
-					findLinkObjectInParentLinkRecursive(base_link, link_name);
-				if (target_link != NULL) {
-					break;
-				}
-			}
-		}
-	}
-	return target_link;
+	auto robot_it = _robot_links.find(robot_name);
+	if (robot_it == _robot_links.end()) {
+		throw std::invalid_argument("Could not find robot in chai world: " +
+									robot_name);
+	}
+	auto link_it = robot_it->second.find(link_name);
+	if (link_it == robot_it->second.end()) {
+		throw std::invalid_argument("Could not find link " + link_name +
+									" in robot " + robot_name +
+									" in chai world");
+	}
+	return link_it->second;
 }
 
 void SaiGraphics::showLinkFrameRecursive(cRobotLink* parent, bool show_frame,
@@ -1038,18 +2092,11 @@ void SaiGraphics::showLinkFrame(bool show_frame,
 								 const std::string& link_name,
 								 const double frame_pointer_length) {
 	if (link_name.empty()) {  // apply to all links
-		cGenericObject* base = NULL;
-		for (unsigned int i = 0; i < _world->getNumChildren(); ++i) {
-			if (robot_or_object_name == _world->getChild(i)->m_name) {
-				base = _world->getChild(i);
-				if (base != NULL) {
-					break;
-				}
-			}
-		}
+		cGenericObject* base = findRobotOrObject(robot_or_object_name);
 		if (base == NULL) {
 			cerr << "Could not find robot in chai world: "
 				 << robot_or_object_name << ". Cannot show frame." << endl;
+			return;
 		}
 		base->setFrameSize(frame_pointer_length, false);
 		base->setShowFrame(show_frame, false);
@@ -1075,43 +2122,30 @@ void SaiGraphics::showWireMesh(bool show_wiremesh,
 								const std::string& robot_or_object_name,
 								const std::string& link_name) {
 	if (link_name.empty()) {  // apply to all links
-		cGenericObject* base = NULL;
-		for (unsigned int i = 0; i < _world->getNumChildren(); ++i) {
-			if (robot_or_object_name == _world->getChild(i)->m_name) {
-				base = _world->getChild(i);
-				if (base != NULL) {
-					break;
-				}
-			}
-		}
+		cGenericObject* base = findRobotOrObject(robot_or_object_name);
 		if (base == NULL) {
 			cerr << "Could not find robot or object in chai graphics world: "
 				 << robot_or_object_name << ". Cannot show wire mesh." << endl;
+			return;
 		}
 		base->setWireMode(show_wiremesh, true);
 	} else {
 		auto target_link = findLink(robot_or_object_name, link_name);
 		target_link->setWireMode(show_wiremesh, true);
 	}
+	_shadow_maps_dirty = true;
 }
 
 void SaiGraphics::setRenderingEnabled(const bool rendering_enabled,
 									   const string robot_or_object_name,
 									   const string link_name) {
 	if (link_name.empty()) {  // apply to all links
-		cGenericObject* base = NULL;
-		for (unsigned int i = 0; i < _world->getNumChildren(); ++i) {
-			if (robot_or_object_name == _world->getChild(i)->m_name) {
-				base = _world->getChild(i);
-				if (base != NULL) {
-					break;
-				}
-			}
-		}
+		cGenericObject* base = findRobotOrObject(robot_or_object_name);
 		if (base == NULL) {
 			cerr << "Could not find robot or object in chai graphics world: "
 				 << robot_or_object_name << ". Cannot enable/disable rendering."
 				 << endl;
+			return;
 		}
 		base->setEnabled(rendering_enabled, true);
 	} else {
@@ -1128,6 +2162,7 @@ void SaiGraphics::setRenderingEnabled(const bool rendering_enabled,
 			}
 		}
 	}
+	_shadow_maps_dirty = true;
 }
 
 }  // namespace SaiGraphics
@@ -10,7 +10,24 @@
 
 #include <chai3d.h>
 
+#include <atomic>
+#include <unordered_map>
+
 #include "SaiModel.h"
+#include "camera/AsyncReadback.h"
+#include "camera/CameraModel.h"
+#include "camera/FrustumCulling.h"
+#include "camera/PointCloud.h"
+#include "camera/Segmentation.h"
+#include "camera/SharedFrameRing.h"
+#include "camera/VideoRecorder.h"
+#include "chai_extension/CCaptureFrameBuffer.h"
+#include "chai_extension/CRobotBase.h"
+#include "chai_extension/CRobotLink.h"
+#include "parser/Tessellation.h"
+#include "utils/HeadlessContext.h"
+#include "utils/ThreadPool.h"
+#include "utils/TripleBuffer.h"
 #include "widgets/ForceSensorDisplay.h"
 #include "widgets/UIForceWidget.h"
 
@@ -37,6 +54,61 @@ struct CameraLinkAttachment {
 		  pose_in_link(pose_in_link) {}
 };
 
+/**
+ * @brief Base structure for the typed handles to elements of the graphics
+ * world. A handle is resolved once from a name (see
+ * SaiGraphics::getRobotHandle and similar functions) and can then be used in
+ * the per frame update functions without any string lookup. Handles are
+ * invalidated when the world is reset.
+ *
+ */
+struct GraphicsHandle {
+	/// @brief index of the element in the graphics world, -1 if not resolved
+	int index = -1;
+	/// @brief id of the world in which the handle was resolved
+	unsigned int world_id = 0;
+
+	/// @brief returns true if the handle was resolved to an element
+	bool isValid() const { return index >= 0; }
+};
+
+/// @brief Handle to a robot in the graphics world
+struct RobotHandle : public GraphicsHandle {};
+
+/// @brief Handle to a dynamic object in the graphics world
+struct ObjectHandle : public GraphicsHandle {};
+
+/// @brief Handle to a camera in the graphics world
+struct CameraHandle : public GraphicsHandle {};
+
+/// @brief Handle to a force sensor display in the graphics world
+struct ForceSensorHandle : public GraphicsHandle {};
+
+/// @brief Size of a camera image in pixels
+struct CameraImageSize {
+	int width = 720;
+	int height = 480;
+};
+
+/**
+ * @brief Ticket identifying an asynchronous camera image request (see
+ * SaiGraphics::requestCameraImage)
+ *
+ */
+struct CameraImageTicket {
+	/// @brief index of the camera, -1 if the ticket was not issued
+	int camera_index = -1;
+	/// @brief id of the world in which the request was made
+	unsigned int world_id = 0;
+	/// @brief index of the pixel buffer used for the request
+	unsigned int buffer_index = 0;
+	/// @brief unique identifier of the request
+	unsigned long long request_id = 0;
+
+	/// @brief returns true if the ticket was issued by a request
+	bool isValid() const { return camera_index >= 0; }
+};
+
 /**
  * @brief Class that represents a visual model of the virtual world.
  *
@@ -50,10 +122,17 @@ public:
 	 * virtual world (urdf and yml files supported).
 	 * @param verbose To display information about the robot model creation in
 	 * the terminal or not.
+	 * @param headless If true, no window is created and the rendering is done
+	 * in an offscreen EGL context, for machines without a display. Only the
+	 * camera images can be rendered in that mode (see getCameraImage).
+	 * @param tessellation Tessellation of the spheres, cylinders and capsules
+	 * of the world (see setTessellationSettings).
 	 */
 	SaiGraphics(const std::string& path_to_world_file,
 				const std::string& window_name = "sai world",
-				bool verbose = false);
+				bool verbose = false, const bool headless = false,
+				const Parser::TessellationSettings& tessellation =
+					Parser::TessellationSettings());
 
 	/**
 	 * @brief Destructor
@@ -72,9 +151,27 @@ public:
 					const bool verbose = false);
 
 	/**
-	 * @brief returns true is the window is open and should stay open
+	 * @brief Same as resetWorld, loading the new world with new tessellation
+	 * settings (see setTessellationSettings)
+	 *
+	 * @param path_to_world_file world file to render
+	 * @param tessellation tessellation settings
+	 * @param verbose print info to terminal or not
+	 */
+	void resetWorld(const std::string& path_to_world_file,
+					const Parser::TessellationSettings& tessellation,
+					const bool verbose = false);
+
+	/**
+	 * @brief returns true is the window is open and should stay open. Always
+	 * true in headless mode.
 	 */
-	bool isWindowOpen() { return !glfwWindowShouldClose(_window); }
+	bool isWindowOpen() {
+		return _window == NULL || !glfwWindowShouldClose(_window);
+	}
+
+	/// @brief returns true if the graphics were created without a window
+	bool isHeadless() const { return _window == NULL; }
 
 	/**
 	 * @brief Call this function to render a black screen in the window
@@ -84,10 +181,34 @@ public:
 
 	/**
 	 * @brief renders the graphics world from the current camera (needs to be
-	 * called after all the update functions i.e. updateRobotGraphics)
+	 * called after all the update functions i.e. updateRobotGraphics). In
+	 * headless mode, this only applies the published states.
 	 */
 	void renderGraphicsWorld();
 
+	/**
+	 * @brief Runs the rendering loop on the calling thread at the given
+	 * target frame rate, until the window is closed or stopRenderLoop is
+	 * called. GLFW requires the window to be handled by the main thread, so
+	 * this should be called from the main thread while the application
+	 * (simulation, controller...) runs in other threads. These threads push
+	 * the robot and object states with publishRobotState and
+	 * publishObjectState, and read the ui torques with getUITorques (from a
+	 * single thread). The ui force interactions must be added before starting
+	 * the loop, and no other function of this class should be called while it
+	 * runs. Not available in headless mode.
+	 *
+	 * @param target_fps target frame rate of the rendering in Hz
+	 */
+	void runRenderLoop(const double target_fps = 60.0);
+
+	/// @brief Makes runRenderLoop return after the current frame. Can be
+	/// called from any thread.
+	void stopRenderLoop() { _render_loop_stop_requested = true; }
+
+	/// @brief returns true if runRenderLoop is running
+	bool isRenderLoopRunning() const { return _render_loop_running; }
+
 	/**
 	 * @brief Gets the camera image for any camera in the world (not necessarily
 	 * the current one)
@@ -101,17 +222,75 @@ public:
 									 const int width = 720,
 									 const int height = 480);
 
+	/**
+	 * @brief Gets the camera image for a camera given by its handle
+	 *
+	 * @param camera handle of the camera obtained with getCameraHandle
+	 * @param width width of the image in pixels
+	 * @param height height of the image in pixels
+	 * @return chai3d::cImagePtr image from the camera as a chai3d image
+	 */
+	chai3d::cImagePtr getCameraImage(const CameraHandle& camera,
+									 const int width = 720,
+									 const int height = 480);
+
+	/**
+	 * @brief Gets the camera image into an existing image, to avoid
+	 * allocations when capturing images repeatedly. The image is only
+	 * reallocated if its size or format (RGBA, 8 bits per channel) does not
+	 * match, and the camera frame buffer is only resized when the requested
+	 * size changes.
+	 *
+	 * @param camera handle of the camera obtained with getCameraHandle
+	 * @param image image in which to write the camera image
+	 * @param width width of the image in pixels
+	 * @param height height of the image in pixels
+	 */
+	void getCameraImage(const CameraHandle& camera, chai3d::cImagePtr image,
+						const int width = 720, const int height = 480);
+
+	/**
+	 * @brief Same as getCameraImage with a handle and an existing image, for a
+	 * camera given by its name
+	 */
+	void getCameraImage(const std::string& camera_name,
+						chai3d::cImagePtr image, const int width = 720,
+						const int height = 480);
+
+	/**
+	 * @brief Gets the camera image into memory owned by the caller, without
+	 * any allocation. The pixels are written as RGBA with 8 bits per channel,
+	 * row by row starting from the bottom row of the image (OpenGL
+	 * convention).
+	 *
+	 * @param camera handle of the camera obtained with getCameraHandle
+	 * @param data pointer to the first pixel of the bottom row, the memory
+	 * must hold height rows of row_stride bytes
+	 * @param width width of the image in pixels
+	 * @param height height of the image in pixels
+	 * @param row_stride number of bytes between the start of two consecutive
+	 * rows, must be a multiple of 4 and at least 4 * width. 0 for 4 * width.
+	 */
+	void getCameraImage(const CameraHandle& camera, unsigned char* data,
+						const int width, const int height,
+						const size_t row_stride = 0);
+
 	/**
 	 * @brief remove all interactions widgets
 	 * after calling that function, right clicking on the window won't
 	 * display lines and generate forces/joint torques
 	 *
 	 */
-	void clearUIForceWidgets() { _ui_force_widgets.clear(); }
+	void clearUIForceWidgets() {
+		_ui_force_widgets.clear();
+		_ui_torques_buffers.clear();
+	}
 
 	/**
 	 * @brief get the joint torques from the ui interaction (right click on
-	 * robot link) for a given robot
+	 * robot link) for a given robot. When runRenderLoop is running, this
+	 * returns the torques computed at the last rendered frame and can be
+	 * called from the application thread.
 	 *
 	 * @param robot_name name of the robot for which we want the joint torques
 	 * @return joint torques from UI interaction for that robot
@@ -142,6 +321,439 @@ public:
 	 */
 	const std::vector<std::string> getObjectNames() const;
 
+	/**
+	 * @brief Gets the metric depth image of a camera: the distance along the
+	 * camera Z axis for each pixel, in meters, +infinity where nothing was
+	 * rendered. Rows are stored from the bottom row of the image to the top
+	 * one, like the color images.
+	 *
+	 * @param camera handle of the camera obtained with getCameraHandle
+	 * @param depth depth of the pixels, resized to width * height if needed
+	 * @param width width of the image in pixels
+	 * @param height height of the image in pixels
+	 */
+	void getCameraDepth(const CameraHandle& camera, std::vector<float>& depth,
+						const int width = 720, const int height = 480);
+
+	/**
+	 * @brief Same as getCameraDepth with a handle, for a camera given by its
+	 * name
+	 */
+	void getCameraDepth(const std::string& camera_name,
+						std::vector<float>& depth, const int width = 720,
+						const int height = 480);
+
+	/**
+	 * @brief Gets the color and metric depth images of a camera, both from
+	 * the same rendering of the camera view (so they are aligned). See
+	 * getCameraImage and getCameraDepth for the formats.
+	 *
+	 * @param camera handle of the camera obtained with getCameraHandle
+	 * @param image image in which to write the color image
+	 * @param depth depth of the pixels, resized to width * height if needed
+	 * @param width width of the image in pixels
+	 * @param height height of the image in pixels
+	 */
+	void getCameraImageAndDepth(const CameraHandle& camera,
+								chai3d::cImagePtr image,
+								std::vector<float>& depth,
+								const int width = 720,
+								const int height = 480);
+
+	/**
+	 * @brief Computes the point cloud seen by a camera from its depth image
+	 * (and color image if requested), in the world frame or in the camera
+	 * frame of getCameraPose. The cloud buffers are reused, so calling this
+	 * repeatedly with the same cloud does not allocate.
+	 *
+	 * @param camera handle of the camera obtained with getCameraHandle
+	 * @param cloud output point cloud
+	 * @param settings options of the point cloud (organized or not, frame,
+	 * colors, voxel downsampling)
+	 * @param width width of the depth image in pixels
+	 * @param height height of the depth image in pixels
+	 */
+	void getCameraPointCloud(
+		const CameraHandle& camera, PointCloud& cloud,
+		const PointCloudSettings& settings = PointCloudSettings(),
+		const int width = 720, const int height = 480);
+
+	/**
+	 * @brief Same as getCameraPointCloud with a handle, for a camera given by
+	 * its name
+	 */
+	void getCameraPointCloud(
+		const std::string& camera_name, PointCloud& cloud,
+		const PointCloudSettings& settings = PointCloudSettings(),
+		const int width = 720, const int height = 480);
+
+	/**
+	 * @brief Gets the segmentation image of a camera: the id of the robot link
+	 * or object seen at each pixel, 0 for the background. The ids are mapped
+	 * back to robot and link names with getSegmentationLabels. The robot links
+	 * and objects are rendered with flat colors encoding their ids, without
+	 * lighting, shadows, textures or widgets. Rows are stored from the bottom
+	 * row of the image to the top one, like the color images.
+	 *
+	 * @param camera handle of the camera obtained with getCameraHandle
+	 * @param ids id of each pixel, resized to width * height if needed
+	 * @param width width of the image in pixels
+	 * @param height height of the image in pixels
+	 */
+	void getCameraSegmentation(const CameraHandle& camera,
+							   std::vector<unsigned int>& ids,
+							   const int width = 720, const int height = 480);
+
+	/**
+	 * @brief Same as getCameraSegmentation with a handle, for a camera given
+	 * by its name
+	 */
+	void getCameraSegmentation(const std::string& camera_name,
+							   std::vector<unsigned int>& ids,
+							   const int width = 720, const int height = 480);
+
+	/**
+	 * @brief Returns the labels of the segmentation ids, indexed by id. The ids
+	 * are assigned when the world is loaded: robot links first (robot by
+	 * robot), then dynamic objects, then static objects. The id 0 is the
+	 * background.
+	 */
+	const std::vector<SegmentationLabel>& getSegmentationLabels() const {
+		return _segmentation_pass.labels();
+	}
+
+	/**
+	 * @brief Enables or disables the view frustum culling (enabled by
+	 * default). When enabled, the robot links and objects whose bounding
+	 * sphere is outside the view of the rendering camera are not drawn. They
+	 * still cast shadows.
+	 *
+	 * @param enabled true to enable the culling
+	 */
+	void setFrustumCullingEnabled(const bool enabled) {
+		_frustum_culler.setEnabled(enabled);
+	}
+
+	/// @brief returns true if the view frustum culling is enabled
+	bool isFrustumCullingEnabled() const { return _frustum_culler.isEnabled(); }
+
+	/**
+	 * @brief Returns the number of robot links and objects that were culled
+	 * in the last rendering (window view or camera capture)
+	 */
+	unsigned int getNumCulledNodes() const {
+		return _frustum_culler.numCulledNodes();
+	}
+
+	/**
+	 * @brief Enables or disables the levels of detail (enabled by default).
+	 * Meshes of more than chai3d::C_LOD_MIN_TRIANGLES triangles get decimated
+	 * versions when the world is loaded. When enabled, each camera draws the
+	 * coarsest version whose error is below the maximum error on screen (see
+	 * setLevelOfDetailMaxPixelError), with some hysteresis so that the meshes
+	 * do not flicker between versions.
+	 *
+	 * @param enabled true to enable the levels of detail
+	 */
+	void setLevelOfDetailEnabled(const bool enabled) {
+		_frustum_culler.setLevelOfDetailEnabled(enabled);
+	}
+
+	/// @brief returns true if the levels of detail are enabled
+	bool isLevelOfDetailEnabled() const {
+		return _frustum_culler.isLevelOfDetailEnabled();
+	}
+
+	/**
+	 * @brief Sets the maximum error of the levels of detail on screen
+	 *
+	 * @param max_pixel_error maximum error in pixels (1 by default)
+	 */
+	void setLevelOfDetailMaxPixelError(const double max_pixel_error);
+
+	/**
+	 * @brief Sets the tessellation of the spheres, cylinders and capsules of
+	 * the URDF files: the number of triangles of each primitive is adapted to
+	 * its size so that its surface is within a maximum chord error, which can
+	 * be set per link or object name. The settings are used by the next calls
+	 * to resetWorld. To load a world with them only once, give them to the
+	 * constructor or to resetWorld instead.
+	 *
+	 * @param tessellation tessellation settings
+	 */
+	void setTessellationSettings(
+		const Parser::TessellationSettings& tessellation);
+
+	/// @brief returns the tessellation settings used when loading the world
+	const Parser::TessellationSettings& getTessellationSettings() const {
+		return _tessellation_settings;
+	}
+
+	/**
+	 * @brief Returns the pinhole intrinsics of a camera for images of the given
+	 * size, computed from the field of view and clipping planes of the camera
+	 *
+	 * @param camera_name name of the camera
+	 * @param width width of the image in pixels
+	 * @param height height of the image in pixels
+	 * @return CameraIntrinsics intrinsics of the camera
+	 */
+	CameraIntrinsics getCameraIntrinsics(const std::string& camera_name,
+										 const int width = 720,
+										 const int height = 480);
+
+	/**
+	 * @brief Sets the near and far clipping planes of a camera. Nothing closer
+	 * than the near plane or further than the far plane is rendered.
+	 *
+	 * @param camera_name name of the camera
+	 * @param near_plane distance of the near plane in meters
+	 * @param far_plane distance of the far plane in meters
+	 */
+	void setCameraClippingPlanes(const std::string& camera_name,
+								 const double near_plane,
+								 const double far_plane);
+
+	/**
+	 * @brief Sets the vertical field of view of a camera
+	 *
+	 * @param camera_name name of the camera
+	 * @param vertical_fov_deg vertical field of view in degrees
+	 */
+	void setCameraFieldOfView(const std::string& camera_name,
+							  const double vertical_fov_deg);
+
+	/**
+	 * @brief Gets the images of several cameras at once. The shadow maps are
+	 * updated once for all the cameras, then the cameras are rendered back to
+	 * back, the transfer of the pixels of each camera overlapping with the
+	 * rendering of the next ones.
+	 *
+	 * @param cameras handles of the cameras obtained with getCameraHandle,
+	 * each camera can appear only once
+	 * @param images the images of the cameras (same order as cameras). The
+	 * vector is resized if needed and the existing images are reused.
+	 * @param sizes size of the image for each camera (same order as cameras).
+	 * A single size is used for all the cameras, and an empty vector uses the
+	 * default size of getCameraImage.
+	 */
+	void getCameraImages(const std::vector<CameraHandle>& cameras,
+						 std::vector<chai3d::cImagePtr>& images,
+						 const std::vector<CameraImageSize>& sizes = {});
+
+	/**
+	 * @brief Gets the images of several cameras given by their names. See the
+	 * version with handles.
+	 *
+	 * @param camera_names names of the cameras
+	 * @param sizes size of the image for each camera (or a single size for
+	 * all, or empty for the default size)
+	 * @return std::vector<chai3d::cImagePtr> the images of the cameras, in the
+	 * same order as camera_names
+	 */
+	std::vector<chai3d::cImagePtr> getCameraImages(
+		const std::vector<std::string>& camera_names,
+		const std::vector<CameraImageSize>& sizes = {});
+
+	/**
+	 * @brief Renders the image of a camera and starts reading it back
+	 * asynchronously, without waiting for the pixels. The image is collected
+	 * later with getRequestedCameraImage, typically after rendering the next
+	 * frame, so that the transfer overlaps with other work. Each camera keeps
+	 * a ring of pixel buffers (see setNumCameraReadbackBuffers): when more
+	 * requests are pending for a camera than there are buffers, the oldest
+	 * one is dropped.
+	 *
+	 * @param camera handle of the camera obtained with getCameraHandle
+	 * @param width width of the image in pixels
+	 * @param height height of the image in pixels
+	 * @return CameraImageTicket ticket identifying the request
+	 */
+	CameraImageTicket requestCameraImage(const CameraHandle& camera,
+										 const int width = 720,
+										 const int height = 480);
+
+	/**
+	 * @brief Same as requestCameraImage with a handle, for a camera given by
+	 * its name
+	 */
+	CameraImageTicket requestCameraImage(const std::string& camera_name,
+										 const int width = 720,
+										 const int height = 480);
+
+	/**
+	 * @brief returns true if the image of an asynchronous request can be
+	 * collected without waiting, false if the transfer is still in progress
+	 * or if the request was dropped or already collected
+	 */
+	bool isCameraImageReady(const CameraImageTicket& ticket);
+
+	/**
+	 * @brief Collects the image of an asynchronous request, waiting for the
+	 * transfer to finish if needed. The image is in the same format as the
+	 * one returned by getCameraImage. Throws if the request was dropped or
+	 * already collected.
+	 *
+	 * @param ticket ticket returned by requestCameraImage
+	 * @return chai3d::cImagePtr image from the camera
+	 */
+	chai3d::cImagePtr getRequestedCameraImage(const CameraImageTicket& ticket);
+
+	/**
+	 * @brief Collects the image of an asynchronous request into an existing
+	 * image, which is only reallocated if its size or format does not match.
+	 * See the version returning a new image.
+	 *
+	 * @param ticket ticket returned by requestCameraImage
+	 * @param image image in which to write the camera image
+	 */
+	void getRequestedCameraImage(const CameraImageTicket& ticket,
+								 chai3d::cImagePtr image);
+
+	/**
+	 * @brief Sets the number of pixel buffers used by each camera for the
+	 * asynchronous image requests (2 by default). Pending requests are
+	 * dropped.
+	 *
+	 * @param num_buffers number of buffers per camera, at least 1
+	 */
+	void setNumCameraReadbackBuffers(const unsigned int num_buffers);
+
+	/**
+	 * @brief Starts recording the images of a camera to a video file. While
+	 * recording, renderGraphicsWorld captures a frame at the requested rate
+	 * (wall clock time) and hands it to a background encoder thread. If the
+	 * encoder falls behind, frames are dropped instead of slowing down the
+	 * rendering (see getRecordingStatistics). A recording already running for
+	 * this camera is stopped first.
+	 *
+	 * @param camera_name name of the camera
+	 * @param path path of the video file
+	 * @param fps frame rate of the video
+	 * @param format format of the video (Y4M, RawRGB or MJPEG if ffmpeg is
+	 * available)
+	 * @param width width of the video in pixels
+	 * @param height height of the video in pixels
+	 */
+	void startRecording(
+		const std::string& camera_name, const std::string& path,
+		const double fps = 30.0,
+		const VideoRecorder::Format format = VideoRecorder::Y4M,
+		const int width = 720, const int height = 480);
+
+	/**
+	 * @brief Stops the recording of a camera, after the frames waiting for the
+	 * encoder are written
+	 *
+	 * @param camera_name name of the camera
+	 * @return VideoRecorder::Statistics final counters of the recording
+	 */
+	VideoRecorder::Statistics stopRecording(const std::string& camera_name);
+
+	/// @brief returns true if the camera is being recorded
+	bool isRecording(const std::string& camera_name);
+
+	/**
+	 * @brief Publishes every image captured from a camera (getCameraImage,
+	 * getCameraImages and getCameraImageAndDepth) to a ring buffer in POSIX
+	 * shared memory, where other processes can read it without copies with a
+	 * SharedFrameReader. Each frame is stamped with the time given to
+	 * setSimulationTime. Images larger than the maximum size are not
+	 * published.
+	 *
+	 * @param camera_name name of the camera
+	 * @param shared_memory_name name of the shared memory segment, replaced
+	 * if it exists
+	 * @param num_slots number of frames in the ring
+	 * @param max_width maximum width of the published images
+	 * @param max_height maximum height of the published images
+	 */
+	void publishCameraFrames(const std::string& camera_name,
+							 const std::string& shared_memory_name,
+							 const unsigned int num_slots = 4,
+							 const int max_width = 1920,
+							 const int max_height = 1080);
+
+	/**
+	 * @brief Stops publishing the images of a camera and removes its shared
+	 * memory segment
+	 *
+	 * @param camera_name name of the camera
+	 */
+	void stopPublishingCameraFrames(const std::string& camera_name);
+
+	/**
+	 * @brief Same as publishCameraFrames for the view rendered in the window
+	 * by renderGraphicsWorld. Not available in headless mode.
+	 */
+	void publishWindowFrames(const std::string& shared_memory_name,
+							 const unsigned int num_slots = 4,
+							 const int max_width = 1920,
+							 const int max_height = 1080);
+
+	/// @brief stops publishing the window view
+	void stopPublishingWindowFrames();
+
+	/**
+	 * @brief Sets the simulation time stamped on the frames published in
+	 * shared memory
+	 *
+	 * @param time simulation time in seconds
+	 */
+	void setSimulationTime(const double time) { _simulation_time = time; }
+
+	/**
+	 * @brief Returns the counters of the recording of a camera (captured,
+	 * written and dropped frames)
+	 *
+	 * @param camera_name name of the camera
+	 * @return VideoRecorder::Statistics counters of the recording
+	 */
+	VideoRecorder::Statistics getRecordingStatistics(
+		const std::string& camera_name);
+
+	/**
+	 * @brief Resolve the handle of a robot, to be used in the update functions
+	 * instead of the robot name. Throws if the robot does not exist.
+	 *
+	 * @param robot_name name of the robot
+	 * @return RobotHandle handle to the robot
+	 */
+	RobotHandle getRobotHandle(const std::string& robot_name) const;
+
+	/**
+	 * @brief Resolve the handle of a dynamic object, to be used in the update
+	 * functions instead of the object name. Throws if the object does not
+	 * exist or is not dynamic.
+	 *
+	 * @param object_name name of the object
+	 * @return ObjectHandle handle to the object
+	 */
+	ObjectHandle getObjectHandle(const std::string& object_name) const;
+
+	/**
+	 * @brief Resolve the handle of a camera, to be used in the image capture
+	 * functions instead of the camera name. Throws if the camera does not
+	 * exist.
+	 *
+	 * @param camera_name name of the camera
+	 * @return CameraHandle handle to the camera
+	 */
+	CameraHandle getCameraHandle(const std::string& camera_name) const;
+
+	/**
+	 * @brief Resolve the handle of a force sensor display previously added
+	 * with addForceSensorDisplay. Throws if there is no such display.
+	 *
+	 * @param robot_or_object_name name of the robot or object the sensor is
+	 * attached to
+	 * @param link_name name of the link the sensor is attached to
+	 * @return ForceSensorHandle handle to the force sensor display
+	 */
+	ForceSensorHandle getForceSensorHandle(
+		const std::string& robot_or_object_name,
+		const std::string& link_name) const;
+
 	/**
 	 * @brief Update the graphics model for a robot in the virtual world.
 	 * Provide the velocities if you want to use the ui interaction widget
@@ -174,6 +786,164 @@ public:
 		const std::string& object_name, const Eigen::Affine3d& object_pose,
 		const Eigen::Vector6d& object_velocity = Eigen::Vector6d::Zero());
 
+	/**
+	 * @brief Update the graphics model for a robot given by its handle.
+	 * @param robot handle of the robot obtained with getRobotHandle
+	 * @param joint_angles joint angles for that robot
+	 * @param joint_velocities joint velocities for that robot
+	 */
+	void updateRobotGraphics(const RobotHandle& robot,
+							 const Eigen::VectorXd& joint_angles,
+							 const Eigen::VectorXd& joint_velocities);
+
+	/**
+	 * @brief Update the graphics model for a robot given by its handle,
+	 * without providing the velocities.
+	 * @param robot handle of the robot obtained with getRobotHandle
+	 * @param joint_angles joint angles for that robot
+	 */
+	void updateRobotGraphics(const RobotHandle& robot,
+							 const Eigen::VectorXd& joint_angles);
+
+	/**
+	 * @brief Update the graphics model of several robots at once. The robot
+	 * kinematics and link pose updates of the different robots run in
+	 * parallel on the update thread pool (see setNumUpdateThreads). Nothing
+	 * is rendered, so this needs to be called from the thread that calls
+	 * renderGraphicsWorld, and each robot can appear only once.
+	 *
+	 * @param robots handles of the robots to update
+	 * @param joint_angles joint angles for each robot (same order as robots)
+	 * @param joint_velocities joint velocities for each robot (same order as
+	 * robots). Leave empty to set the velocities to zero.
+	 */
+	void updateRobotsGraphics(
+		const std::vector<RobotHandle>& robots,
+		const std::vector<Eigen::VectorXd>& joint_angles,
+		const std::vector<Eigen::VectorXd>& joint_velocities = {});
+
+	/**
+	 * @brief Update the graphics model of several robots at once, given by
+	 * their names. See the version using handles.
+	 *
+	 * @param robot_names names of the robots to update
+	 * @param joint_angles joint angles for each robot (same order as
+	 * robot_names)
+	 * @param joint_velocities joint velocities for each robot (same order as
+	 * robot_names). Leave empty to set the velocities to zero.
+	 */
+	void updateRobotsGraphics(
+		const std::vector<std::string>& robot_names,
+		const std::vector<Eigen::VectorXd>& joint_angles,
+		const std::vector<Eigen::VectorXd>& joint_velocities = {});
+
+	/**
+	 * @brief Sets the number of threads used by updateRobotsGraphics
+	 * (including the calling thread). By default, the number of hardware
+	 * threads is used. 1 makes the batched update serial.
+	 *
+	 * @param num_threads number of threads, 0 for the number of hardware
+	 * threads
+	 */
+	void setNumUpdateThreads(const unsigned int num_threads) {
+		_update_thread_pool = std::make_unique<ThreadPool>(num_threads);
+	}
+
+	/// @brief returns the number of threads used by updateRobotsGraphics
+	unsigned int getNumUpdateThreads() const;
+
+	/**
+	 * @brief Sets the tolerance under which a robot or object update is
+	 * considered to not change anything. If all the joint positions and
+	 * velocities of a robot (or all the pose and velocity coefficients of an
+	 * object) differ from the last applied ones by at most the tolerance, the
+	 * update is skipped and the robot (or object) is left where it was. The
+	 * default is 0, which only skips updates with the exact same values.
+	 *
+	 * @param tolerance the tolerance, must be non negative
+	 */
+	void setUpdateTolerance(const double tolerance);
+
+	/// @brief returns the tolerance used to skip unchanged updates
+	double getUpdateTolerance() const { return _update_tolerance; }
+
+	/**
+	 * @brief Update the graphics model for an object given by its handle.
+	 * @param object handle of the object obtained with getObjectHandle
+	 * @param object_pose pose of the object in the world
+	 * @param object_velocity velocity of the object in the world
+	 */
+	void updateObjectGraphics(
+		const ObjectHandle& object, const Eigen::Affine3d& object_pose,
+		const Eigen::Vector6d& object_velocity = Eigen::Vector6d::Zero());
+
+	/**
+	 * @brief Publishes the state of a robot from any thread (typically a
+	 * simulation thread). This never blocks: the state is stored in a lock
+	 * free triple buffer and applied to the graphics model at the next call
+	 * to applyPublishedStates (done at the beginning of renderGraphicsWorld).
+	 * If several states are published between two renders, only the latest
+	 * one is used. Only one thread may publish for a given robot, and the
+	 * world must not be reset while publishing.
+	 *
+	 * @param robot handle of the robot obtained with getRobotHandle
+	 * @param joint_angles joint angles for that robot
+	 * @param joint_velocities joint velocities for that robot
+	 */
+	void publishRobotState(const RobotHandle& robot,
+						   const Eigen::VectorXd& joint_angles,
+						   const Eigen::VectorXd& joint_velocities);
+
+	/**
+	 * @brief Publishes the state of a robot from any thread, without
+	 * providing the velocities (they are set to zero). See the version with
+	 * velocities.
+	 *
+	 * @param robot handle of the robot obtained with getRobotHandle
+	 * @param joint_angles joint angles for that robot
+	 */
+	void publishRobotState(const RobotHandle& robot,
+						   const Eigen::VectorXd& joint_angles);
+
+	/**
+	 * @brief Publishes the state of a dynamic object from any thread. Same
+	 * rules as publishRobotState.
+	 *
+	 * @param object handle of the object obtained with getObjectHandle
+	 * @param object_pose pose of the object in the world
+	 * @param object_velocity velocity of the object in the world
+	 */
+	void publishObjectState(
+		const ObjectHandle& object, const Eigen::Affine3d& object_pose,
+		const Eigen::Vector6d& object_velocity = Eigen::Vector6d::Zero());
+
+	/**
+	 * @brief Applies the latest robot and object states published since the
+	 * last call to the graphics models. Called automatically by
+	 * renderGraphicsWorld, it needs to be called explicitly only when
+	 * rendering camera images without rendering the window.
+	 */
+	void applyPublishedStates();
+
+	/**
+	 * @brief Enables or disables the interpolation of the published states.
+	 * When enabled, the two latest states published for each robot and object
+	 * are kept with the time at which they were published, and the states
+	 * applied at render time are interpolated between them (linearly for the
+	 * joint angles and positions, with slerp for the object orientations),
+	 * with a delay of one publication interval. This gives a smooth motion
+	 * at the display rate when the states are published at a lower or
+	 * irregular rate. If no new state arrives in time, the motion is
+	 * extrapolated for at most max_extrapolation_time. Robots with spherical
+	 * joints are not interpolated. Disabled by default.
+	 *
+	 * @param enabled true to interpolate the published states
+	 * @param max_extrapolation_time maximum time in seconds during which the
+	 * states are extrapolated past the latest published one
+	 */
+	void setStateInterpolation(const bool enabled,
+							   const double max_extrapolation_time = 0.0);
+
 	/**
 	 * @brief Get the Joint positions of a given robot in the graphics world
 	 *
@@ -311,9 +1081,21 @@ public:
 	void updateDisplayedForceSensor(
 		const SaiModel::ForceSensorData& force_data);
 
+	/**
+	 * @brief updates the displayed force sensor given by its handle with the
+	 * new force and moment values.
+	 *
+	 * @param sensor handle of the sensor obtained with getForceSensorHandle
+	 * @param force_world_frame force to display, in world frame
+	 * @param moment_world_frame moment to display, in world frame
+	 */
+	void updateDisplayedForceSensor(const ForceSensorHandle& sensor,
+									const Eigen::Vector3d& force_world_frame,
+									const Eigen::Vector3d& moment_world_frame);
+
 	/// @brief returns true if the given key is pressed, false otherwise
 	bool isKeyPressed(int key) const {
-		return glfwGetKey(_window, key) == GLFW_PRESS;
+		return _window != NULL && glfwGetKey(_window, key) == GLFW_PRESS;
 	}
 
 	/**
@@ -354,6 +1136,280 @@ public:
 	bool cameraExistsInWorld(const std::string& camera_name) const;
 
 private:
+	/**
+	 * @brief A robot link in the flattened update order of a robot
+	 */
+	struct RobotLinkGraphicsData {
+		/// @brief link object in the chai world
+		chai3d::cRobotLink* link;
+		/// @brief index of the parent link in the update order, -1 if the
+		/// parent is the robot base
+		int parent_index;
+		/// @brief name of the link in the robot model
+		std::string link_name;
+		/// @brief index of the link in the frustum culler, -1 if it has no
+		/// visual
+		int culling_index = -1;
+	};
+
+	/// @brief robot state passed through the publication triple buffers
+	struct PublishedRobotState {
+		Eigen::VectorXd joint_angles;
+		Eigen::VectorXd joint_velocities;
+		/// @brief time of publication in seconds (steady clock)
+		double timestamp = 0.0;
+	};
+
+	/// @brief object state passed through the publication triple buffers
+	struct PublishedObjectState {
+		Eigen::Affine3d pose = Eigen::Affine3d::Identity();
+		Eigen::Vector6d velocity = Eigen::Vector6d::Zero();
+		/// @brief time of publication in seconds (steady clock)
+		double timestamp = 0.0;
+	};
+
+	/**
+	 * @brief Graphics data of a robot, stored contiguously and accessed by
+	 * index from a RobotHandle
+	 */
+	struct RobotGraphicsData {
+		/// @brief name of the robot
+		std::string name;
+		/// @brief robot model
+		std::shared_ptr<SaiModel::SaiModel> model;
+		/// @brief robot base object in the chai world
+		chai3d::cRobotBase* base;
+		/// @brief zero joint velocities used when none are provided
+		Eigen::VectorXd zero_dq;
+		/// @brief links of the robot sorted such that parents always come
+		/// before their children
+		std::vector<RobotLinkGraphicsData> links;
+		/// @brief transforms of the links in the robot base frame, computed
+		/// during the last update (same order as links)
+		std::vector<Eigen::Affine3d> link_transforms;
+		/// @brief true if the links need to be updated at the next update
+		/// even if the joint state did not change
+		bool needs_update = true;
+		/// @brief states published from other threads
+		std::unique_ptr<TripleBuffer<PublishedRobotState>> published_state;
+		/// @brief two latest states fetched from the publication buffer
+		PublishedRobotState previous_state, latest_state;
+		/// @brief number of states fetched since the world was loaded, up to 2
+		int num_fetched_states = 0;
+		/// @brief joint angles and velocities interpolated at render time
+		Eigen::VectorXd interpolated_q, interpolated_dq;
+	};
+
+	/**
+	 * @brief Graphics data of a dynamic object, stored contiguously and
+	 * accessed by index from an ObjectHandle
+	 */
+	struct ObjectGraphicsData {
+		/// @brief name of the object
+		std::string name;
+		/// @brief object in the chai world
+		chai3d::cGenericObject* object;
+		/// @brief pose of the object (shared with the widgets)
+		std::shared_ptr<Eigen::Affine3d> pose;
+		/// @brief velocity of the object (shared with the widgets)
+		std::shared_ptr<Eigen::Vector6d> velocity;
+		/// @brief index of the object in the frustum culler, -1 if it has no
+		/// visual
+		int culling_index = -1;
+		/// @brief states published from other threads
+		std::unique_ptr<TripleBuffer<PublishedObjectState>> published_state;
+		/// @brief two latest states fetched from the publication buffer
+		PublishedObjectState previous_state, latest_state;
+		/// @brief number of states fetched since the world was loaded, up to 2
+		int num_fetched_states = 0;
+	};
+
+	/**
+	 * @brief Graphics data of a camera, stored contiguously and accessed by
+	 * index from a CameraHandle
+	 */
+	struct CameraGraphicsData {
+		/// @brief name of the camera
+		std::string name;
+		/// @brief frame buffer used to render the camera offscreen
+		chai3d::cCaptureFrameBufferPtr frame_buffer;
+		/// @brief ring of pixel buffers for the asynchronous image requests,
+		/// created on first request
+		std::unique_ptr<AsyncReadback> readback;
+		/// @brief pixel buffer used by the batched captures, kept separate
+		/// from the ring above to not drop pending requests
+		std::unique_ptr<AsyncReadback> batch_readback;
+		/// @brief depth and color images kept between point cloud captures
+		std::vector<float> depth_scratch;
+		std::vector<unsigned char> pixels_scratch;
+		/// @brief video recording of the camera, if any
+		std::unique_ptr<VideoRecorder> recorder;
+		/// @brief shared memory ring the captured images are published to,
+		/// if any
+		std::unique_ptr<SharedFrameWriter> frame_publisher;
+		/// @brief time at which the next video frame is captured
+		double next_recording_time = 0.0;
+	};
+
+	/**
+	 * @brief Computes the flattened link update order of a robot from the
+	 * chai link tree under its base
+	 *
+	 * @param robot graphics data of the robot
+	 */
+	void buildLinkUpdateOrder(RobotGraphicsData& robot);
+
+	/**
+	 * @brief Adds the links under the given parent to the link update order
+	 * of the robot, parents first (depth first)
+	 *
+	 * @param robot graphics data of the robot
+	 * @param parent the object under which to look for links
+	 * @param parent_index index of the parent in the update order (-1 for the
+	 * robot base)
+	 */
+	void buildLinkUpdateOrderRecursive(RobotGraphicsData& robot,
+									   chai3d::cGenericObject* parent,
+									   const int parent_index);
+
+	/**
+	 * @brief Registers the robot links and objects of the world in the
+	 * segmentation pass
+	 */
+	void buildSegmentationLabels();
+
+	/**
+	 * @brief Updates the robot model and the chai links of a robot. Nothing is
+	 * done if the joint state did not change by more than the update
+	 * tolerance since the last update.
+	 *
+	 * @param robot graphics data of the robot
+	 * @param joint_angles joint angles for that robot
+	 * @param joint_velocities joint velocities for that robot
+	 */
+	void updateRobotGraphicsInternal(RobotGraphicsData& robot,
+									 const Eigen::VectorXd& joint_angles,
+									 const Eigen::VectorXd& joint_velocities);
+
+	/**
+	 * @brief Updates the pose and velocity of a dynamic object. The chai
+	 * object is only moved if the pose changed by more than the update
+	 * tolerance.
+	 *
+	 * @param object graphics data of the object
+	 * @param object_pose pose of the object in the world
+	 * @param object_velocity velocity of the object in the world
+	 */
+	void updateObjectGraphicsInternal(ObjectGraphicsData& object,
+									  const Eigen::Affine3d& object_pose,
+									  const Eigen::Vector6d& object_velocity);
+
+	/**
+	 * @brief Renders the view of a camera in its frame buffer, updating the
+	 * shadow maps first if needed. The frame buffer is only resized if the
+	 * size changed.
+	 *
+	 * @param camera graphics data of the camera
+	 * @param width width of the image in pixels
+	 * @param height height of the image in pixels
+	 */
+	void renderCameraView(CameraGraphicsData& camera, const int width,
+						  const int height);
+
+	/**
+	 * @brief Reads the RGBA pixels last rendered by a camera into the given
+	 * memory
+	 *
+	 * @param camera graphics data of the camera
+	 * @param data pointer to the first pixel of the bottom row
+	 * @param row_stride number of bytes between two rows (multiple of 4)
+	 */
+	void readCameraPixels(CameraGraphicsData& camera, unsigned char* data,
+						  const size_t row_stride);
+
+	/**
+	 * @brief Captures the frames of the camera recordings that are due
+	 *
+	 */
+	void recordCameraFrames();
+
+	/**
+	 * @brief Publishes the view last captured from a camera if it is published
+	 * in shared memory, copying the pixels already read by the capture
+	 *
+	 * @param camera graphics data of the camera
+	 * @param pixels RGBA pixels of the view, from the bottom row
+	 * @param row_stride number of bytes between two rows of pixels
+	 */
+	void publishCameraFrame(CameraGraphicsData& camera,
+							const unsigned char* pixels,
+							const size_t row_stride);
+
+	/// @brief publishes the view rendered in the window if enabled
+	void publishWindowFrame();
+
+	/**
+	 * @brief Reads the depth buffer last rendered by a camera and converts it
+	 * to metric depth
+	 *
+	 * @param camera graphics data of the camera
+	 * @param depth output depth, resized if needed
+	 */
+	void readCameraDepth(CameraGraphicsData& camera, std::vector<float>& depth);
+
+	/**
+	 * @brief Checks that a camera image ticket was issued in the current world
+	 * and throws otherwise
+	 *
+	 * @param ticket the ticket to check
+	 * @param function_name name of the calling function for the error message
+	 */
+	void checkCameraImageTicket(const CameraImageTicket& ticket,
+								const std::string& function_name) const;
+
+	/**
+	 * @brief Renders a camera in its frame buffer and returns the image
+	 *
+	 * @param camera graphics data of the camera
+	 * @param width width of the image in pixels
+	 * @param height height of the image in pixels
+	 * @return chai3d::cImagePtr image from the camera
+	 */
+	chai3d::cImagePtr getCameraImageInternal(CameraGraphicsData& camera,
+											 const int width,
+											 const int height);
+
+	/**
+	 * @brief Computes the interpolation factor between the two latest
+	 * published states of a robot or object at the current time. 0 gives the
+	 * previous state, 1 the latest one, and values above 1 extrapolate.
+	 *
+	 * @param previous_timestamp time of publication of the previous state
+	 * @param latest_timestamp time of publication of the latest state
+	 * @param current_time current time
+	 * @return double the interpolation factor
+	 */
+	double interpolationFactor(const double previous_timestamp,
+							   const double latest_timestamp,
+							   const double current_time) const;
+
+	/**
+	 * @brief Regenerates the shadow maps of the world if a robot, an object
+	 * or any other element casting shadows changed since the last shadow pass
+	 */
+	void updateShadowMapsIfNeeded();
+
+	/**
+	 * @brief Checks that a handle was resolved in the current world and points
+	 * to an existing element, and throws otherwise
+	 *
+	 * @param handle the handle to check
+	 * @param num_elements the number of elements of that type in the world
+	 * @param function_name name of the calling function for the error message
+	 */
+	void checkHandle(const GraphicsHandle& handle, const size_t num_elements,
+					 const std::string& function_name) const;
+
 	/**
 	 * @brief Initialize the world with the given world file
 	 *
@@ -370,11 +1426,13 @@ private:
 	void clearWorld();
 
 	/**
-	 * @brief initialize the glfw window with the given window name
+	 * @brief initialize the glfw window with the given window name, or the
+	 * offscreen context in headless mode
 	 *
 	 * @param window_name
+	 * @param headless true to create an offscreen context instead of a window
 	 */
-	void initializeWindow(const std::string& window_name);
+	void initializeWindow(const std::string& window_name, const bool headless);
 
 	/**
 	 * @brief Render the virtual world to the current context.
@@ -420,16 +1478,32 @@ private:
 	chai3d::cCamera* getCamera(const std::string& camera_name);
 
 	/**
-	 * @brief find the link object in the parent link recursively (called by the
-	 * findLink function)
+	 * @brief builds the name based index of the robot bases, robot links and
+	 * objects of the chai world. Called when the world is initialized so that
+	 * later lookups don't need to go through the world children.
+	 */
+	void buildWorldIndex();
+
+	/**
+	 * @brief adds all the links found under the parent object (recursively)
+	 * to the given link index
 	 *
-	 * @param parent parent link
-	 * @param link_name name of the link to find
-	 * @return chai3d::cRobotLink* pointer to the found link (or null pointer if
+	 * @param parent the object under which to look for links
+	 * @param link_index the map from link names to link objects to fill
+	 */
+	void indexRobotLinksRecursive(
+		chai3d::cGenericObject* parent,
+		std::unordered_map<std::string, chai3d::cRobotLink*>& link_index);
+
+	/**
+	 * @brief find the chai object representing a robot base or an object
+	 *
+	 * @param robot_or_object_name the name of the robot or object
+	 * @return chai3d::cGenericObject* pointer to the object (or null pointer if
 	 * not found)
 	 */
-	chai3d::cRobotLink* findLinkObjectInParentLinkRecursive(
-		chai3d::cRobotLink* parent, const std::string& link_name);
+	chai3d::cGenericObject* findRobotOrObject(
+		const std::string& robot_or_object_name) const;
 
 	/**
 	 * @brief find the link defined by the robot and link name
@@ -465,9 +1539,12 @@ private:
 	/// @brief pointer to the chai3d world
 	chai3d::cWorld* _world;
 
-	/// @brief pointer to the glfw window
+	/// @brief pointer to the glfw window, null in headless mode
 	GLFWwindow* _window;
 
+	/// @brief offscreen context used in headless mode
+	std::unique_ptr<HeadlessContext> _headless_context;
+
 	/**
 	 * @brief the widgets responsible for handling the computation of joint
 	 * torques when right clicking and dragging the mouse on the display window
@@ -478,6 +1555,16 @@ private:
 	/// @brief flag to know if a right click interaction is occurring
 	bool _right_click_interaction_occurring;
 
+	/// @brief ui torques computed by the render loop for the application
+	/// thread (same order as _ui_force_widgets)
+	std::vector<std::unique_ptr<TripleBuffer<Eigen::VectorXd>>>
+		_ui_torques_buffers;
+
+	/// @brief true while runRenderLoop is running
+	std::atomic<bool> _render_loop_running;
+	/// @brief set by stopRenderLoop to exit the render loop
+	std::atomic<bool> _render_loop_stop_requested;
+
 	/// @brief maps from robot names to filename
 	std::map<std::string, std::string> _robot_filenames;
 	/// @brief maps from robot names to robot models
@@ -490,6 +1577,65 @@ private:
 	std::map<std::string, std::shared_ptr<Eigen::Affine3d>>
 		_static_objects_pose;
 
+	/// @brief maps from robot names to robot base objects in the chai world
+	std::unordered_map<std::string, chai3d::cRobotBase*> _robot_bases;
+	/// @brief maps from robot names to the map from link names to link objects
+	std::unordered_map<std::string,
+					   std::unordered_map<std::string, chai3d::cRobotLink*>>
+		_robot_links;
+	/// @brief maps from (static and dynamic) object names to chai objects
+	std::unordered_map<std::string, chai3d::cGenericObject*> _object_nodes;
+
+	/// @brief id of the current world, incremented each time the world is
+	/// initialized to invalidate the existing handles
+	unsigned int _world_id;
+	/// @brief graphics data of the robots, indexed by the robot handles
+	std::vector<RobotGraphicsData> _robots;
+	/// @brief maps from robot names to index in _robots
+	std::unordered_map<std::string, int> _robot_indices;
+	/// @brief graphics data of the dynamic objects, indexed by the object
+	/// handles
+	std::vector<ObjectGraphicsData> _objects;
+	/// @brief maps from dynamic object names to index in _objects
+	std::unordered_map<std::string, int> _object_indices;
+	/// @brief graphics data of the cameras, indexed by the camera handles (in
+	/// the same order as _camera_names)
+	std::vector<CameraGraphicsData> _cameras;
+	/// @brief maps from camera names to index in _cameras
+	std::unordered_map<std::string, int> _camera_indices;
+	/// @brief state switching the world to the segmentation rendering
+	SegmentationPass _segmentation_pass;
+	/// @brief bounding spheres of the robot links and objects, used to skip
+	/// the ones outside of the view of the rendering camera
+	FrustumCuller _frustum_culler;
+	/// @brief tessellation of the primitives of the loaded worlds
+	Parser::TessellationSettings _tessellation_settings;
+	/// @brief scratch memory of the point cloud computations
+	PointCloudGenerator _point_cloud_generator;
+	/// @brief shared memory ring the window view is published to, if any
+	std::unique_ptr<SharedFrameWriter> _window_frame_publisher;
+	/// @brief simulation time stamped on the published frames
+	double _simulation_time;
+	/// @brief number of pixel buffers used for the asynchronous image requests
+	/// of each camera
+	unsigned int _num_camera_readback_buffers;
+	/// @brief identifier of the next asynchronous camera image request
+	unsigned long long _next_camera_image_request_id;
+
+	/// @brief tolerance under which robot and object updates are skipped
+	double _update_tolerance;
+	/// @brief true if the published states are interpolated at render time
+	bool _state_interpolation_enabled;
+	/// @brief maximum extrapolation time past the latest published state
+	double _max_extrapolation_time;
+	/// @brief true if the shadow maps need to be regenerated before the next
+	/// render. Atomic because it is set from the batched update threads
+	std::atomic<bool> _shadow_maps_dirty;
+
+	/// @brief thread pool used for the batched robot updates, created on
+	/// first use if not configured with setNumUpdateThreads
+	std::unique_ptr<ThreadPool> _update_thread_pool;
+
 	/// @brief vector of force sensor displays
 	std::vector<std::shared_ptr<ForceSensorDisplay>> _force_sensor_displays;
 
@@ -0,0 +1,161 @@
+#include "AsyncReadback.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace SaiGraphics {
+
+namespace {
+// bytes per pixel of the RGBA images
+const int PIXEL_SIZE = 4;
+// maximum time waited on a fence at once in nanoseconds
+const unsigned long long FENCE_WAIT_TIMEOUT = 100000000;
+}  // namespace
+
+AsyncReadback::AsyncReadback(const unsigned int num_buffers)
+	: _next_buffer(0) {
+	if (num_buffers == 0) {
+		throw std::invalid_argument(
+			"number of buffers should be at least 1 in AsyncReadback");
+	}
+	_buffers.resize(num_buffers);
+}
+
+AsyncReadback::~AsyncReadback() {
+	for (auto& buffer : _buffers) {
+		releaseFence(buffer);
+		if (buffer.pbo != 0) {
+			glDeleteBuffers(1, &buffer.pbo);
+		}
+	}
+}
+
+unsigned int AsyncReadback::startRead(const int width, const int height,
+									  const unsigned long long read_id) {
+	const unsigned int buffer_index = _next_buffer;
+	_next_buffer = (_next_buffer + 1) % _buffers.size();
+
+	// if the buffer still holds a read that was not collected, it is dropped
+	PixelBuffer& buffer = _buffers[buffer_index];
+	releaseFence(buffer);
+	buffer.width = width;
+	buffer.height = height;
+	buffer.read_id = read_id;
+	buffer.pending = true;
+	const size_t size = (size_t)width * height * PIXEL_SIZE;
+
+#ifdef MACOSX
+	buffer.pixels.resize(size);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE,
+				 buffer.pixels.data());
+#else
+	if (buffer.pbo == 0) {
+		glGenBuffers(1, &buffer.pbo);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.pbo);
+	// only reallocate the storage when the image gets bigger
+	if (size > buffer.capacity) {
+		glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+		buffer.capacity = size;
+	}
+	// with a pack buffer bound, this only queues the copy
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#endif
+	return buffer_index;
+}
+
+bool AsyncReadback::isPending(const unsigned int buffer_index,
+							  const unsigned long long read_id) const {
+	return buffer_index < _buffers.size() &&
+		   _buffers[buffer_index].pending &&
+		   _buffers[buffer_index].read_id == read_id;
+}
+
+bool AsyncReadback::isReady(const unsigned int buffer_index,
+							const unsigned long long read_id) {
+	if (!isPending(buffer_index, read_id)) {
+		return false;
+	}
+#ifdef MACOSX
+	return true;
+#else
+	const GLenum status =
+		glClientWaitSync(_buffers[buffer_index].fence,
+						 GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+	return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+#endif
+}
+
+bool AsyncReadback::collect(const unsigned int buffer_index,
+							const unsigned long long read_id,
+							chai3d::cImagePtr image) {
+	if (!isPending(buffer_index, read_id)) {
+		return false;
+	}
+	PixelBuffer& buffer = _buffers[buffer_index];
+	const size_t size = (size_t)buffer.width * buffer.height * PIXEL_SIZE;
+	if (image->getWidth() != buffer.width ||
+		image->getHeight() != buffer.height ||
+		image->getFormat() != GL_RGBA ||
+		image->getType() != GL_UNSIGNED_BYTE) {
+		image->allocate(buffer.width, buffer.height, GL_RGBA,
+						GL_UNSIGNED_BYTE);
+	}
+#ifdef MACOSX
+	memcpy(image->getData(), buffer.pixels.data(), size);
+#else
+	if (!waitForFence(buffer)) {
+		throw std::runtime_error(
+			"failed to wait for the pixel transfer in AsyncReadback::collect");
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.pbo);
+	const void* pixels =
+		glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+	if (pixels != NULL) {
+		memcpy(image->getData(), pixels, size);
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	if (pixels == NULL) {
+		throw std::runtime_error(
+			"failed to map the pixel buffer in AsyncReadback::collect");
+	}
+#endif
+	releaseFence(buffer);
+	buffer.pending = false;
+	return true;
+}
+
+bool AsyncReadback::waitForFence(PixelBuffer& buffer) {
+#ifdef MACOSX
+	return true;
+#else
+	if (buffer.fence == 0) {
+		return true;
+	}
+	while (true) {
+		const GLenum status = glClientWaitSync(
+			buffer.fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_WAIT_TIMEOUT);
+		if (status == GL_ALREADY_SIGNALED ||
+			status == GL_CONDITION_SATISFIED) {
+			return true;
+		}
+		if (status == GL_WAIT_FAILED) {
+			return false;
+		}
+	}
+#endif
+}
+
+void AsyncReadback::releaseFence(PixelBuffer& buffer) {
+#ifndef MACOSX
+	if (buffer.fence != 0) {
+		glDeleteSync(buffer.fence);
+		buffer.fence = 0;
+	}
+#endif
+}
+
+}  // namespace SaiGraphics
@@ -0,0 +1,126 @@
+/**
+ * \file AsyncReadback.h
+ *
+ * \brief Asynchronous read back of rendered images through a ring of OpenGL
+ * pixel buffer objects.
+ */
+
+#ifndef SAI_GRAPHICS_ASYNC_READBACK_H
+#define SAI_GRAPHICS_ASYNC_READBACK_H
+
+#include <chai3d.h>
+
+#include <vector>
+
+namespace SaiGraphics {
+
+/**
+ * @brief Ring of pixel buffer objects used to read the rendered images of a
+ * camera without stalling. startRead queues the copy of the currently bound
+ * read frame buffer in the next buffer of the ring and returns immediately,
+ * the pixels are collected later with collect, by which time the GPU has
+ * usually finished the copy (for example while the next frame was rendered).
+ *
+ * If more reads are started than there are buffers in the ring, the oldest
+ * ones are overwritten and can't be collected anymore. All the functions need
+ * the OpenGL context in which the images are rendered to be current.
+ */
+class AsyncReadback {
+public:
+	/**
+	 * @brief Creates the ring. The OpenGL buffers are created on first use.
+	 *
+	 * @param num_buffers number of buffers in the ring (at least 1)
+	 */
+	explicit AsyncReadback(const unsigned int num_buffers = 2);
+
+	/**
+	 * @brief Deletes the OpenGL buffers and fences
+	 *
+	 */
+	~AsyncReadback();
+
+	AsyncReadback(const AsyncReadback&) = delete;
+	AsyncReadback& operator=(const AsyncReadback&) = delete;
+
+	/**
+	 * @brief Starts reading the RGBA pixels of the currently bound read frame
+	 * buffer in the next buffer of the ring.
+	 *
+	 * @param width width of the image to read
+	 * @param height height of the image to read
+	 * @param read_id identifier of the read, used to check that the buffer
+	 * was not reused when collecting it
+	 * @return unsigned int index of the buffer used for the read
+	 */
+	unsigned int startRead(const int width, const int height,
+						   const unsigned long long read_id);
+
+	/**
+	 * @brief returns true if the read identified by read_id can be collected
+	 * without waiting. Returns false if the read is not in the ring anymore.
+	 */
+	bool isReady(const unsigned int buffer_index,
+				 const unsigned long long read_id);
+
+	/**
+	 * @brief returns true if the buffer still holds the read identified by
+	 * read_id and it was not collected yet
+	 */
+	bool isPending(const unsigned int buffer_index,
+				   const unsigned long long read_id) const;
+
+	/**
+	 * @brief Waits for the read to be finished and copies the pixels to the
+	 * given image (resized if needed, RGBA 8 bits per channel, bottom row
+	 * first as returned by OpenGL). The buffer can then be reused.
+	 *
+	 * @param buffer_index index of the buffer returned by startRead
+	 * @param read_id identifier given to startRead
+	 * @param image image in which to copy the pixels
+	 * @return false if the read is not in the ring anymore, true otherwise
+	 */
+	bool collect(const unsigned int buffer_index,
+				 const unsigned long long read_id, chai3d::cImagePtr image);
+
+	/// @brief number of buffers in the ring
+	unsigned int numBuffers() const { return _buffers.size(); }
+
+private:
+	/// @brief one pixel buffer object of the ring
+	struct PixelBuffer {
+		/// @brief OpenGL pixel buffer object (0 until first used)
+		GLuint pbo = 0;
+		/// @brief size of the allocated buffer storage in bytes
+		size_t capacity = 0;
+		/// @brief size of the image being read
+		int width = 0;
+		int height = 0;
+		/// @brief identifier of the read, and whether it was collected
+		unsigned long long read_id = 0;
+		bool pending = false;
+#ifdef MACOSX
+		/// @brief pixels read synchronously (fences are not available with
+		/// the legacy OpenGL context used on macOS)
+		std::vector<unsigned char> pixels;
+#else
+		/// @brief fence signaled when the copy to the buffer is done
+		GLsync fence = 0;
+#endif
+	};
+
+	/// @brief waits for the fence of a buffer, returns false on error
+	bool waitForFence(PixelBuffer& buffer);
+
+	/// @brief releases the fence of a buffer
+	void releaseFence(PixelBuffer& buffer);
+
+	/// @brief the buffers of the ring
+	std::vector<PixelBuffer> _buffers;
+	/// @brief index of the buffer used by the next read
+	unsigned int _next_buffer;
+};
+
+}  // namespace SaiGraphics
+
+#endif	// SAI_GRAPHICS_ASYNC_READBACK_H
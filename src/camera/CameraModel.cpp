@@ -0,0 +1,41 @@
+#include "CameraModel.h"
+
+#include <cmath>
+#include <limits>
+
+namespace SaiGraphics {
+
+CameraIntrinsics computeCameraIntrinsics(const int width, const int height,
+										 const double vertical_fov_deg,
+										 const double near_plane,
+										 const double far_plane) {
+	CameraIntrinsics intrinsics;
+	intrinsics.width = width;
+	intrinsics.height = height;
+	intrinsics.fy =
+		0.5 * height / std::tan(0.5 * vertical_fov_deg * M_PI / 180.0);
+	intrinsics.fx = intrinsics.fy;
+	// the image spans [-0.5, width - 0.5] with pixel centers at integers
+	intrinsics.cx = 0.5 * (width - 1);
+	intrinsics.cy = 0.5 * (height - 1);
+	intrinsics.near_plane = near_plane;
+	intrinsics.far_plane = far_plane;
+	return intrinsics;
+}
+
+void linearizeDepthBuffer(float* depth, const size_t num_pixels,
+						  const double near_plane, const double far_plane) {
+	// inverse of the perspective projection: with the normalized device
+	// coordinate z_ndc = 2 * d - 1, the depth is
+	// 2 * n * f / (f + n - z_ndc * (f - n)) = n * f / (f - d * (f - n))
+	const float a = near_plane * far_plane;
+	const float b = far_plane;
+	const float c = far_plane - near_plane;
+	const float infinity = std::numeric_limits<float>::infinity();
+	for (size_t i = 0; i < num_pixels; ++i) {
+		const float d = depth[i];
+		depth[i] = d >= 1.0f ? infinity : a / (b - d * c);
+	}
+}
+
+}  // namespace SaiGraphics
@@ -0,0 +1,69 @@
+/**
+ * \file CameraModel.h
+ *
+ * \brief Pinhole model of the cameras of the graphics world, and conversion
+ * of their OpenGL depth buffers to metric depth.
+ */
+
+#ifndef SAI_GRAPHICS_CAMERA_MODEL_H
+#define SAI_GRAPHICS_CAMERA_MODEL_H
+
+#include <cstddef>
+
+namespace SaiGraphics {
+
+/**
+ * @brief Pinhole intrinsics of a camera rendering images of a given size. They
+ * use the usual computer vision conventions: the image origin is at the top
+ * left, with pixel centers at integer coordinates, and the camera frame is X
+ * right, Y down and Z forward (same as SaiGraphics::getCameraPose).
+ */
+struct CameraIntrinsics {
+	/// @brief image size in pixels
+	int width = 0;
+	int height = 0;
+	/// @brief focal lengths in pixels
+	double fx = 0.0;
+	double fy = 0.0;
+	/// @brief principal point in pixels
+	double cx = 0.0;
+	double cy = 0.0;
+	/// @brief distance of the near and far clipping planes in meters
+	double near_plane = 0.0;
+	double far_plane = 0.0;
+};
+
+/**
+ * @brief Computes the intrinsics of a perspective camera from its vertical
+ * field of view, with square pixels and the principal point at the center of
+ * the image.
+ *
+ * @param width image width in pixels
+ * @param height image height in pixels
+ * @param vertical_fov_deg vertical field of view in degrees
+ * @param near_plane distance of the near clipping plane
+ * @param far_plane distance of the far clipping plane
+ * @return CameraIntrinsics the intrinsics of the camera
+ */
+CameraIntrinsics computeCameraIntrinsics(const int width, const int height,
+										 const double vertical_fov_deg,
+										 const double near_plane,
+										 const double far_plane);
+
+/**
+ * @brief Converts in place the values of an OpenGL depth buffer (in [0, 1],
+ * rendered with a perspective projection) to the metric depth along the
+ * camera Z axis. Pixels at the far plane, where nothing was rendered, are set
+ * to +infinity.
+ *
+ * @param depth the depth buffer values
+ * @param num_pixels number of values
+ * @param near_plane distance of the near clipping plane
+ * @param far_plane distance of the far clipping plane
+ */
+void linearizeDepthBuffer(float* depth, const size_t num_pixels,
+						  const double near_plane, const double far_plane);
+
+}  // namespace SaiGraphics
+
+#endif	// SAI_GRAPHICS_CAMERA_MODEL_H
@@ -0,0 +1,200 @@
+#include "FrustumCulling.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "chai_extension/CRobotLink.h"
+
+using namespace chai3d;
+
+namespace SaiGraphics {
+
+namespace {
+// relative width of the hysteresis band of the level of detail selection
+const double LOD_HYSTERESIS = 0.25;
+}  // namespace
+
+FrustumCuller::FrustumCuller()
+	: _num_culled_nodes(0),
+	  _enabled(true),
+	  _lod_enabled(true),
+	  _max_pixel_error(1.0) {}
+
+int FrustumCuller::addNode(cGenericObject* root) {
+	Node node;
+	if (dynamic_cast<cRobotLink*>(root) != NULL) {
+		for (unsigned int i = 0; i < root->getNumChildren(); ++i) {
+			cGenericObject* child = root->getChild(i);
+			if (dynamic_cast<cRobotLink*>(child) == NULL) {
+				node.visuals.push_back(child);
+			}
+		}
+	} else {
+		node.visuals.push_back(root);
+	}
+	if (node.visuals.empty()) {
+		return -1;
+	}
+
+	// boundary box of the visuals in the node frame
+	Eigen::Vector3d box_min = Eigen::Vector3d::Constant(INFINITY);
+	Eigen::Vector3d box_max = Eigen::Vector3d::Constant(-INFINITY);
+	bool bounded = true;
+	for (auto visual : node.visuals) {
+		visual->computeBoundaryBox(true);
+		if (visual->getBoundaryBoxEmpty()) {
+			bounded = false;
+			break;
+		}
+		const Eigen::Vector3d visual_min = visual->getBoundaryMin().eigen();
+		const Eigen::Vector3d visual_max = visual->getBoundaryMax().eigen();
+		Eigen::Affine3d T_node_visual = Eigen::Affine3d::Identity();
+		if (visual != root) {
+			T_node_visual.translation() = visual->getLocalPos().eigen();
+			T_node_visual.linear() = visual->getLocalRot().eigen();
+		}
+		for (int corner = 0; corner < 8; ++corner) {
+			const Eigen::Vector3d point(
+				(corner & 1) ? visual_max.x() : visual_min.x(),
+				(corner & 2) ? visual_max.y() : visual_min.y(),
+				(corner & 4) ? visual_max.z() : visual_min.z());
+			const Eigen::Vector3d point_in_node = T_node_visual * point;
+			box_min = box_min.cwiseMin(point_in_node);
+			box_max = box_max.cwiseMax(point_in_node);
+		}
+	}
+	if (bounded) {
+		node.local_center = 0.5 * (box_min + box_max);
+		node.radius = 0.5 * (box_max - box_min).norm();
+	} else {
+		node.local_center.setZero();
+		node.radius = -1.0;
+	}
+	node.world_center = node.local_center;
+	for (auto visual : node.visuals) {
+		addLevelsOfDetailRecursive(visual, node);
+	}
+	_nodes.push_back(node);
+	return _nodes.size() - 1;
+}
+
+void FrustumCuller::addLevelsOfDetailRecursive(cGenericObject* object,
+											   Node& node) {
+	cLevelOfDetail* lod = dynamic_cast<cLevelOfDetail*>(object);
+	if (lod != NULL) {
+		node.lods.push_back(lod);
+		return;
+	}
+	for (unsigned int i = 0; i < object->getNumChildren(); ++i) {
+		cGenericObject* child = object->getChild(i);
+		if (dynamic_cast<cRobotLink*>(child) == NULL) {
+			addLevelsOfDetailRecursive(child, node);
+		}
+	}
+}
+
+void FrustumCuller::setNodePose(const int index,
+								const Eigen::Affine3d& T_world_node) {
+	if (index < 0) {
+		return;
+	}
+	Node& node = _nodes[index];
+	node.world_center = T_world_node * node.local_center;
+}
+
+void FrustumCuller::clear() {
+	_nodes.clear();
+	_culled_visuals.clear();
+	_selected_lods.clear();
+	_num_culled_nodes = 0;
+}
+
+void FrustumCuller::begin(cCamera* camera, const unsigned int camera_slot,
+						  const int width, const int height) {
+	// restore the nodes of a rendering that did not reach end
+	end();
+	_num_culled_nodes = 0;
+	if ((!_enabled && !_lod_enabled) || width <= 0 || height <= 0 ||
+		!camera->isViewModePerspective()) {
+		return;
+	}
+
+	// planes of the frustum, with normals pointing inside. A point p is
+	// inside a plane if normal.dot(p) + offset >= 0
+	const Eigen::Vector3d position = camera->getLocalPos().eigen();
+	const Eigen::Vector3d look = camera->getLookVector().eigen();
+	const Eigen::Vector3d up = camera->getUpVector().eigen();
+	const Eigen::Vector3d right = camera->getRightVector().eigen();
+	const double half_vertical_fov =
+		0.5 * camera->getFieldViewAngleDeg() * M_PI / 180.0;
+	const double half_horizontal_fov =
+		atan(tan(half_vertical_fov) * width / height);
+	const double cos_v = cos(half_vertical_fov);
+	const double sin_v = sin(half_vertical_fov);
+	const double cos_h = cos(half_horizontal_fov);
+	const double sin_h = sin(half_horizontal_fov);
+	Eigen::Vector3d normals[6] = {look,
+								  -look,
+								  sin_v * look - cos_v * up,
+								  sin_v * look + cos_v * up,
+								  sin_h * look - cos_h * right,
+								  sin_h * look + cos_h * right};
+	double offsets[6];
+	for (int i = 0; i < 6; ++i) {
+		offsets[i] = -normals[i].dot(position);
+	}
+	const double near_plane = camera->getNearClippingPlane();
+	offsets[0] -= near_plane;
+	offsets[1] += camera->getFarClippingPlane();
+	// size on screen of one meter at a depth of one meter, in pixels
+	const double pixels_per_meter = 0.5 * height / tan(half_vertical_fov);
+
+	for (const auto& node : _nodes) {
+		bool outside = false;
+		if (_enabled && node.radius >= 0) {
+			for (int i = 0; i < 6 && !outside; ++i) {
+				outside = normals[i].dot(node.world_center) + offsets[i] <
+						  -node.radius;
+			}
+		}
+		if (outside) {
+			++_num_culled_nodes;
+			// visuals hidden by the application stay hidden after end
+			for (auto visual : node.visuals) {
+				if (visual->getEnabled()) {
+					visual->setEnabled(false, false);
+					_culled_visuals.push_back(visual);
+				}
+			}
+			continue;
+		}
+		if (!_lod_enabled || node.lods.empty()) {
+			continue;
+		}
+		// the depth of the closest point of the node sets the level of all its
+		// meshes
+		const double depth =
+			std::max(look.dot(node.world_center - position) -
+						 std::max(node.radius, 0.0),
+					 near_plane);
+		for (auto lod : node.lods) {
+			lod->selectLevel(pixels_per_meter / depth, _max_pixel_error,
+							 LOD_HYSTERESIS, camera_slot);
+			_selected_lods.push_back(lod);
+		}
+	}
+}
+
+void FrustumCuller::end() {
+	for (auto visual : _culled_visuals) {
+		visual->setEnabled(true, false);
+	}
+	_culled_visuals.clear();
+	// the shadow maps and the other passes use the full resolution meshes
+	for (auto lod : _selected_lods) {
+		lod->setLevel(0);
+	}
+	_selected_lods.clear();
+}
+
+}  // namespace SaiGraphics
@@ -0,0 +1,134 @@
+/**
+ * \file FrustumCulling.h
+ *
+ * \brief View frustum culling of the robot links and objects of the graphics
+ * world, using a bounding sphere per link and per object, and selection of the
+ * levels of detail of their meshes.
+ */
+
+#ifndef SAI_GRAPHICS_FRUSTUM_CULLING_H
+#define SAI_GRAPHICS_FRUSTUM_CULLING_H
+
+#include <chai3d.h>
+
+#include <Eigen/Dense>
+#include <vector>
+
+#include "chai_extension/LevelOfDetail.h"
+
+namespace SaiGraphics {
+
+/**
+ * @brief Hides the visuals of the registered robot links and objects that are
+ * outside the view frustum of a camera for the time of its rendering.
+ *
+ * The bounding sphere of each node is computed once in the frame of the node
+ * when it is registered, and moved to the world frame when the pose of the
+ * node is updated, so that testing a node against the frustum only costs 6
+ * dot products. The visuals are disabled between begin and end and re-enabled
+ * by end, so the shadow maps, which are rendered outside of begin/end, still
+ * contain the culled nodes.
+ *
+ * For the nodes that are not culled, begin also selects the level of each mesh
+ * with levels of detail (chai3d::cLevelOfDetail) from the projected size of
+ * its geometric error at the depth of the node, keeping one selection per
+ * camera for the hysteresis. end goes back to the full resolution levels.
+ */
+class FrustumCuller {
+public:
+	FrustumCuller();
+
+	/**
+	 * @brief Registers a robot link or an object. Its visuals are all its
+	 * children that are not robot links for a robot link (child links are
+	 * registered separately), and the object itself otherwise.
+	 *
+	 * @param root robot link or object in the chai world
+	 * @return int index of the node to update its pose with setNodePose, -1
+	 * if it has no visual
+	 */
+	int addNode(chai3d::cGenericObject* root);
+
+	/**
+	 * @brief Updates the world pose of a node
+	 *
+	 * @param index index returned by addNode (ignored if negative)
+	 * @param T_world_node pose of the node in the world frame
+	 */
+	void setNodePose(const int index, const Eigen::Affine3d& T_world_node);
+
+	/// @brief removes all the nodes
+	void clear();
+
+	/// @brief enables or disables the culling (enabled by default)
+	void setEnabled(const bool enabled) { _enabled = enabled; }
+	bool isEnabled() const { return _enabled; }
+
+	/// @brief enables or disables the selection of the levels of detail
+	/// (enabled by default)
+	void setLevelOfDetailEnabled(const bool enabled) { _lod_enabled = enabled; }
+	bool isLevelOfDetailEnabled() const { return _lod_enabled; }
+
+	/// @brief maximum error of the selected levels of detail on screen, in
+	/// pixels
+	void setMaxPixelError(const double max_pixel_error) {
+		_max_pixel_error = max_pixel_error;
+	}
+	double maxPixelError() const { return _max_pixel_error; }
+
+	/**
+	 * @brief Hides the nodes outside of the frustum of a camera and selects the
+	 * levels of detail of the others
+	 *
+	 * @param camera camera about to render the world (a child of the world)
+	 * @param camera_slot index of the camera, the level of detail selections
+	 * of each camera are kept separately
+	 * @param width width of the rendered image in pixels
+	 * @param height height of the rendered image in pixels
+	 */
+	void begin(chai3d::cCamera* camera, const unsigned int camera_slot,
+			   const int width, const int height);
+
+	/// @brief shows the nodes hidden by begin, at full resolution
+	void end();
+
+	/// @brief number of nodes culled by the last call to begin
+	unsigned int numCulledNodes() const { return _num_culled_nodes; }
+
+	/// @brief number of registered nodes
+	unsigned int numNodes() const { return _nodes.size(); }
+
+private:
+	/// @brief a registered link or object
+	struct Node {
+		/// @brief objects disabled when the node is culled
+		std::vector<chai3d::cGenericObject*> visuals;
+		/// @brief center of the bounding sphere in the node frame
+		Eigen::Vector3d local_center;
+		/// @brief radius of the bounding sphere, negative if some visual has
+		/// no boundary box (the node is never culled)
+		double radius;
+		/// @brief center of the bounding sphere in the world frame
+		Eigen::Vector3d world_center;
+		/// @brief meshes with levels of detail among the visuals
+		std::vector<chai3d::cLevelOfDetail*> lods;
+	};
+
+	/// @brief adds the levels of detail of a subtree, stopping at robot links
+	void addLevelsOfDetailRecursive(chai3d::cGenericObject* object,
+									Node& node);
+
+	std::vector<Node> _nodes;
+	/// @brief visuals disabled by begin
+	std::vector<chai3d::cGenericObject*> _culled_visuals;
+	/// @brief levels of detail selected by begin
+	std::vector<chai3d::cLevelOfDetail*> _selected_lods;
+	unsigned int _num_culled_nodes;
+	bool _enabled;
+	bool _lod_enabled;
+	double _max_pixel_error;
+};
+
+}  // namespace SaiGraphics
+
+#endif	// SAI_GRAPHICS_FRUSTUM_CULLING_H
@@ -0,0 +1,407 @@
+#include "PointCloud.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace SaiGraphics {
+
+namespace {
+
+/**
+ * Parameters of the unprojection of one image row. The point of the pixel in
+ * column u with depth z is z * (m * a[u] + c) + t where a[u] = (u - cx) / fx,
+ * m is the first column of the rotation of the transform, c the rotation
+ * applied to (0, (v - cy) / fy, 1) and t the translation of the transform.
+ */
+struct RowParameters {
+	float m[3];
+	float c[3];
+	float t[3];
+	/// maximum valid depth, always finite so that infinite depths are dropped
+	float max_depth;
+};
+
+inline bool isValidDepth(const float z, const float max_depth) {
+	// false for NaN
+	return z > 0.0f && z <= max_depth;
+}
+
+inline void copyColor(const unsigned char* rgba, unsigned char* rgb) {
+	rgb[0] = rgba[0];
+	rgb[1] = rgba[1];
+	rgb[2] = rgba[2];
+}
+
+#if defined(__SSE2__)
+// stores 4 points given by their coordinates as 12 interleaved floats
+inline void storeInterleaved(float* out, const __m128 x, const __m128 y,
+							 const __m128 z) {
+	const __m128 xy01 = _mm_unpacklo_ps(x, y);	// x0 y0 x1 y1
+	const __m128 xy23 = _mm_unpackhi_ps(x, y);	// x2 y2 x3 y3
+	const __m128 z0x1 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0));
+	const __m128 y1z1 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1));
+	const __m128 z2x3 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2));
+	const __m128 y3z3 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3));
+	// x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3
+	_mm_storeu_ps(out, _mm_shuffle_ps(xy01, z0x1, _MM_SHUFFLE(2, 0, 1, 0)));
+	_mm_storeu_ps(out + 4,
+				  _mm_shuffle_ps(y1z1, xy23, _MM_SHUFFLE(1, 0, 2, 0)));
+	_mm_storeu_ps(out + 8,
+				  _mm_shuffle_ps(z2x3, y3z3, _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+// stores a block of 4 points, only the valid ones (bits of valid_mask) unless
+// the cloud is organized. Returns the number of points stored
+inline size_t storeBlock(const __m128 x, const __m128 y, const __m128 z,
+						 const int valid_mask, const bool organized,
+						 const unsigned char* rgba, float* points,
+						 unsigned char* colors) {
+	if (organized || valid_mask == 0xf) {
+		storeInterleaved(points, x, y, z);
+		if (colors != NULL) {
+			for (int k = 0; k < 4; ++k) {
+				copyColor(rgba + 4 * k, colors + 3 * k);
+			}
+		}
+		return 4;
+	}
+	if (valid_mask == 0) {
+		return 0;
+	}
+	float block[12];
+	storeInterleaved(block, x, y, z);
+	size_t count = 0;
+	for (int k = 0; k < 4; ++k) {
+		if (valid_mask & (1 << k)) {
+			memcpy(points + 3 * count, block + 3 * k, 3 * sizeof(float));
+			if (colors != NULL) {
+				copyColor(rgba + 4 * k, colors + 3 * count);
+			}
+			++count;
+		}
+	}
+	return count;
+}
+
+// replaces the invalid lanes by NaN
+inline __m128 maskInvalid(const __m128 value, const __m128 valid,
+						  const __m128 nan) {
+	return _mm_or_ps(_mm_and_ps(valid, value), _mm_andnot_ps(valid, nan));
+}
+#endif
+
+/**
+ * Unprojects one row of the depth image and returns the number of points
+ * written. If colors is NULL, the colors are not written.
+ */
+size_t unprojectRow(const RowParameters& p, const float* depth,
+					const float* column_factors, const unsigned char* rgba,
+					const int width, const bool organized, float* points,
+					unsigned char* colors) {
+	size_t count = 0;
+	int u = 0;
+
+#if defined(__AVX__)
+	{
+		const __m256 m0 = _mm256_set1_ps(p.m[0]), m1 = _mm256_set1_ps(p.m[1]),
+					 m2 = _mm256_set1_ps(p.m[2]);
+		const __m256 c0 = _mm256_set1_ps(p.c[0]), c1 = _mm256_set1_ps(p.c[1]),
+					 c2 = _mm256_set1_ps(p.c[2]);
+		const __m256 t0 = _mm256_set1_ps(p.t[0]), t1 = _mm256_set1_ps(p.t[1]),
+					 t2 = _mm256_set1_ps(p.t[2]);
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 max_depth = _mm256_set1_ps(p.max_depth);
+		const __m256 nan =
+			_mm256_set1_ps(std::numeric_limits<float>::quiet_NaN());
+		for (; u + 8 <= width; u += 8) {
+			const __m256 z = _mm256_loadu_ps(depth + u);
+			const __m256 a = _mm256_loadu_ps(column_factors + u);
+			const __m256 valid =
+				_mm256_and_ps(_mm256_cmp_ps(z, zero, _CMP_GT_OQ),
+							  _mm256_cmp_ps(z, max_depth, _CMP_LE_OQ));
+			const int valid_mask = _mm256_movemask_ps(valid);
+			if (!organized && valid_mask == 0) {
+				continue;
+			}
+			__m256 x = _mm256_add_ps(
+				_mm256_mul_ps(z, _mm256_add_ps(_mm256_mul_ps(m0, a), c0)), t0);
+			__m256 y = _mm256_add_ps(
+				_mm256_mul_ps(z, _mm256_add_ps(_mm256_mul_ps(m1, a), c1)), t1);
+			__m256 w = _mm256_add_ps(
+				_mm256_mul_ps(z, _mm256_add_ps(_mm256_mul_ps(m2, a), c2)), t2);
+			if (organized) {
+				x = _mm256_blendv_ps(nan, x, valid);
+				y = _mm256_blendv_ps(nan, y, valid);
+				w = _mm256_blendv_ps(nan, w, valid);
+			}
+			const unsigned char* block_rgba = rgba + 4 * u;
+			count += storeBlock(
+				_mm256_castps256_ps128(x), _mm256_castps256_ps128(y),
+				_mm256_castps256_ps128(w), valid_mask & 0xf, organized,
+				block_rgba, points + 3 * count,
+				colors != NULL ? colors + 3 * count : NULL);
+			count += storeBlock(
+				_mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1),
+				_mm256_extractf128_ps(w, 1), valid_mask >> 4, organized,
+				block_rgba + 16, points + 3 * count,
+				colors != NULL ? colors + 3 * count : NULL);
+		}
+	}
+#endif
+
+#if defined(__SSE2__)
+	{
+		const __m128 m0 = _mm_set1_ps(p.m[0]), m1 = _mm_set1_ps(p.m[1]),
+					 m2 = _mm_set1_ps(p.m[2]);
+		const __m128 c0 = _mm_set1_ps(p.c[0]), c1 = _mm_set1_ps(p.c[1]),
+					 c2 = _mm_set1_ps(p.c[2]);
+		const __m128 t0 = _mm_set1_ps(p.t[0]), t1 = _mm_set1_ps(p.t[1]),
+					 t2 = _mm_set1_ps(p.t[2]);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 max_depth = _mm_set1_ps(p.max_depth);
+		const __m128 nan = _mm_set1_ps(std::numeric_limits<float>::quiet_NaN());
+		for (; u + 4 <= width; u += 4) {
+			const __m128 z = _mm_loadu_ps(depth + u);
+			const __m128 a = _mm_loadu_ps(column_factors + u);
+			const __m128 valid = _mm_and_ps(_mm_cmpgt_ps(z, zero),
+											_mm_cmple_ps(z, max_depth));
+			const int valid_mask = _mm_movemask_ps(valid);
+			if (!organized && valid_mask == 0) {
+				continue;
+			}
+			__m128 x = _mm_add_ps(
+				_mm_mul_ps(z, _mm_add_ps(_mm_mul_ps(m0, a), c0)), t0);
+			__m128 y = _mm_add_ps(
+				_mm_mul_ps(z, _mm_add_ps(_mm_mul_ps(m1, a), c1)), t1);
+			__m128 w = _mm_add_ps(
+				_mm_mul_ps(z, _mm_add_ps(_mm_mul_ps(m2, a), c2)), t2);
+			if (organized) {
+				x = maskInvalid(x, valid, nan);
+				y = maskInvalid(y, valid, nan);
+				w = maskInvalid(w, valid, nan);
+			}
+			count += storeBlock(x, y, w, valid_mask, organized, rgba + 4 * u,
+								points + 3 * count,
+								colors != NULL ? colors + 3 * count : NULL);
+		}
+	}
+#endif
+
+	// remaining pixels (all of them without SSE)
+	const float nan = std::numeric_limits<float>::quiet_NaN();
+	for (; u < width; ++u) {
+		const float z = depth[u];
+		const bool valid = isValidDepth(z, p.max_depth);
+		if (!organized && !valid) {
+			continue;
+		}
+		float* point = points + 3 * count;
+		for (int i = 0; i < 3; ++i) {
+			point[i] =
+				valid ? z * (p.m[i] * column_factors[u] + p.c[i]) + p.t[i]
+					  : nan;
+		}
+		if (colors != NULL) {
+			copyColor(rgba + 4 * u, colors + 3 * count);
+		}
+		++count;
+	}
+	return count;
+}
+
+// number of bits used for each coordinate of the voxel keys
+const int VOXEL_KEY_BITS = 21;
+const uint64_t VOXEL_KEY_MASK = (uint64_t(1) << VOXEL_KEY_BITS) - 1;
+
+inline uint64_t voxelKey(const float* point, const double inverse_size) {
+	// voxel coordinates are wrapped on 21 bits, so voxels more than 2^20
+	// voxels apart can share a key (over a kilometer with 1 mm voxels)
+	uint64_t key = 0;
+	for (int i = 0; i < 3; ++i) {
+		// floor without the libm call, the coordinates are finite
+		const double scaled = point[i] * inverse_size;
+		int64_t coordinate = (int64_t)scaled;
+		coordinate -= scaled < coordinate;
+		key = (key << VOXEL_KEY_BITS) | ((uint64_t)coordinate & VOXEL_KEY_MASK);
+	}
+	return key;
+}
+
+// adds a point (and its color if not NULL) to a voxel
+template <typename Voxel>
+inline void accumulate(Voxel& voxel, const float* point,
+					   const unsigned char* color) {
+	for (int j = 0; j < 3; ++j) {
+		voxel.point_sum[j] += point[j];
+	}
+	if (color != NULL) {
+		for (int j = 0; j < 3; ++j) {
+			voxel.color_sum[j] += color[j];
+		}
+	}
+	++voxel.count;
+}
+
+inline size_t hashVoxelKey(const uint64_t key) {
+	// Fibonacci hashing, the high bits are the best mixed
+	return (size_t)((key * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+}  // namespace
+
+void PointCloudGenerator::compute(const float* depth,
+								  const unsigned char* rgba,
+								  const CameraIntrinsics& intrinsics,
+								  const Eigen::Affine3d& transform,
+								  const PointCloudSettings& settings,
+								  PointCloud& cloud) {
+	const int width = intrinsics.width;
+	const int height = intrinsics.height;
+	if (width <= 0 || height <= 0) {
+		throw std::invalid_argument(
+			"image size should be positive in PointCloudGenerator::compute");
+	}
+	if (settings.with_colors && rgba == NULL) {
+		throw std::invalid_argument(
+			"colors requested without color image in "
+			"PointCloudGenerator::compute");
+	}
+	if (settings.voxel_size < 0 ||
+		(settings.organized && settings.voxel_size > 0)) {
+		throw std::invalid_argument(
+			"voxel size should be positive, and 0 for organized clouds in "
+			"PointCloudGenerator::compute");
+	}
+
+	if (_column_factors.size() != (size_t)width) {
+		_column_factors.resize(width);
+	}
+	for (int u = 0; u < width; ++u) {
+		_column_factors[u] = (u - intrinsics.cx) / intrinsics.fx;
+	}
+
+	// the buffers are sized for the worst case and never shrunk
+	const size_t num_pixels = (size_t)width * height;
+	if (cloud.points.size() < 3 * num_pixels) {
+		cloud.points.resize(3 * num_pixels);
+	}
+	if (settings.with_colors && cloud.colors.size() < 3 * num_pixels) {
+		cloud.colors.resize(3 * num_pixels);
+	}
+
+	const Eigen::Matrix3f rotation = transform.linear().cast<float>();
+	const Eigen::Vector3f translation = transform.translation().cast<float>();
+	RowParameters p;
+	for (int i = 0; i < 3; ++i) {
+		p.m[i] = rotation(i, 0);
+		p.t[i] = translation(i);
+	}
+	p.max_depth = std::min(settings.max_depth,
+						   (double)std::numeric_limits<float>::max());
+
+	size_t count = 0;
+	for (int v = 0; v < height; ++v) {
+		// the image rows are stored from the bottom one
+		const size_t row_offset = (size_t)(height - 1 - v) * width;
+		const float row_factor = (v - intrinsics.cy) / intrinsics.fy;
+		for (int i = 0; i < 3; ++i) {
+			p.c[i] = rotation(i, 1) * row_factor + rotation(i, 2);
+		}
+		count += unprojectRow(
+			p, depth + row_offset, _column_factors.data(),
+			settings.with_colors ? rgba + 4 * row_offset : NULL, width,
+			settings.organized, cloud.points.data() + 3 * count,
+			settings.with_colors ? cloud.colors.data() + 3 * count : NULL);
+	}
+
+	if (settings.organized) {
+		cloud.width = width;
+		cloud.height = height;
+		return;
+	}
+	cloud.width = count;
+	cloud.height = 1;
+	if (settings.voxel_size > 0) {
+		downsample(settings.voxel_size, settings.with_colors, cloud);
+	}
+}
+
+void PointCloudGenerator::downsample(const double voxel_size,
+									 const bool with_colors,
+									 PointCloud& cloud) {
+	const size_t num_points = cloud.size();
+	// power of two size, at most half full
+	size_t table_size = 16;
+	while (table_size < 2 * num_points) {
+		table_size *= 2;
+	}
+	if (_voxel_table.size() < table_size) {
+		_voxel_table.assign(table_size, VoxelCell());
+	}
+	const size_t table_mask = _voxel_table.size() - 1;
+	_voxels.clear();
+	_occupied_cells.clear();
+
+	const double inverse_size = 1.0 / voxel_size;
+	uint64_t last_key = 0;
+	int32_t last_voxel_index = -1;
+	for (size_t i = 0; i < num_points; ++i) {
+		const float* point = cloud.points.data() + 3 * i;
+		const unsigned char* color =
+			with_colors ? cloud.colors.data() + 3 * i : NULL;
+		const uint64_t key = voxelKey(point, inverse_size);
+		// neighboring pixels usually fall in the same voxel, in which case the
+		// table lookup is skipped
+		if (last_voxel_index >= 0 && key == last_key) {
+			accumulate(_voxels[last_voxel_index], point, color);
+			continue;
+		}
+		size_t cell_index = hashVoxelKey(key) & table_mask;
+		while (true) {
+			VoxelCell& cell = _voxel_table[cell_index];
+			if (cell.voxel_index < 0) {
+				cell.key = key;
+				cell.voxel_index = _voxels.size();
+				_occupied_cells.push_back(cell_index);
+				_voxels.push_back(Voxel{{0.0f, 0.0f, 0.0f}, {0, 0, 0}, 0});
+			}
+			if (cell.key == key) {
+				accumulate(_voxels[cell.voxel_index], point, color);
+				last_key = key;
+				last_voxel_index = cell.voxel_index;
+				break;
+			}
+			cell_index = (cell_index + 1) & table_mask;
+		}
+	}
+
+	// the centroids overwrite the points, there are fewer of them
+	for (size_t k = 0; k < _voxels.size(); ++k) {
+		const Voxel& voxel = _voxels[k];
+		for (int j = 0; j < 3; ++j) {
+			cloud.points[3 * k + j] = voxel.point_sum[j] / voxel.count;
+		}
+		if (with_colors) {
+			for (int j = 0; j < 3; ++j) {
+				cloud.colors[3 * k + j] =
+					(voxel.color_sum[j] + voxel.count / 2) / voxel.count;
+			}
+		}
+	}
+	cloud.width = _voxels.size();
+
+	// only the cells used by this cloud are reset
+	for (const size_t cell_index : _occupied_cells) {
+		_voxel_table[cell_index].voxel_index = -1;
+	}
+}
+
+}  // namespace SaiGraphics
@@ -0,0 +1,127 @@
+/**
+ * \file PointCloud.h
+ *
+ * \brief Conversion of the metric depth images of the cameras to point clouds,
+ * vectorized with SSE or AVX when available.
+ */
+
+#ifndef SAI_GRAPHICS_POINT_CLOUD_H
+#define SAI_GRAPHICS_POINT_CLOUD_H
+
+#include <Eigen/Dense>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "CameraModel.h"
+
+namespace SaiGraphics {
+
+/**
+ * @brief A point cloud. The buffers are reused from one computation to the
+ * next and are not shrunk, so once they have grown to the size of the largest
+ * cloud, computing a new cloud neither allocates nor clears memory. They can
+ * therefore hold more values than the cloud has points: only the first size()
+ * points (and colors) are valid.
+ */
+struct PointCloud {
+	/// @brief coordinates of the points in meters, 3 floats per point (x, y, z)
+	std::vector<float> points;
+	/// @brief colors of the points, 3 bytes per point (r, g, b), only updated
+	/// if the colors were requested
+	std::vector<unsigned char> colors;
+	/// @brief size of an organized cloud (same as the image, rows from top to
+	/// bottom). For an unorganized cloud, width is the number of points and
+	/// height is 1
+	int width = 0;
+	int height = 0;
+
+	/// @brief number of points in the cloud
+	size_t size() const { return (size_t)width * height; }
+
+	/// @brief coordinates of the point i
+	const float* point(const size_t i) const { return points.data() + 3 * i; }
+};
+
+/// @brief Options of the point cloud computation
+struct PointCloudSettings {
+	/// @brief if true, the cloud has one point per pixel in the image order,
+	/// with NaN coordinates where there is no depth. Otherwise only the valid
+	/// points are kept
+	bool organized = false;
+	/// @brief if true, the points are expressed in the world frame, otherwise
+	/// in the camera frame (X right, Y down, Z forward)
+	bool world_frame = true;
+	/// @brief if true, the colors of the points are also computed
+	bool with_colors = false;
+	/// @brief size of the voxels used to downsample the cloud in meters, 0 to
+	/// disable. Each occupied voxel is replaced by the centroid (and average
+	/// color) of its points. Only available for unorganized clouds
+	double voxel_size = 0.0;
+	/// @brief points further than this depth are dropped
+	double max_depth = std::numeric_limits<double>::infinity();
+};
+
+/**
+ * @brief Computes point clouds from metric depth images (as returned by
+ * SaiGraphics::getCameraDepth). It holds the scratch memory of the
+ * computation, so it should be reused across frames.
+ */
+class PointCloudGenerator {
+public:
+	PointCloudGenerator() = default;
+
+	/**
+	 * @brief Computes the point cloud of a depth image
+	 *
+	 * @param depth metric depth of the pixels, bottom row first, non finite
+	 * where there is no geometry
+	 * @param rgba colors of the pixels (RGBA 8 bits per channel, bottom row
+	 * first), only used if settings.with_colors is true
+	 * @param intrinsics intrinsics of the camera for the image size
+	 * @param transform transform applied to the points expressed in the
+	 * camera frame (identity for the camera frame, the camera pose for the
+	 * world frame)
+	 * @param settings options of the computation
+	 * @param cloud output cloud
+	 */
+	void compute(const float* depth, const unsigned char* rgba,
+				 const CameraIntrinsics& intrinsics,
+				 const Eigen::Affine3d& transform,
+				 const PointCloudSettings& settings, PointCloud& cloud);
+
+private:
+	/// @brief cell of the voxel hash table
+	struct VoxelCell {
+		uint64_t key = 0;
+		/// @brief index of the voxel in _voxels, -1 if the cell is empty
+		int32_t voxel_index = -1;
+	};
+
+	/// @brief sums of the points falling in a voxel
+	struct Voxel {
+		float point_sum[3];
+		uint32_t color_sum[3];
+		uint32_t count;
+	};
+
+	/**
+	 * @brief Replaces the points of an unorganized cloud by the centroids of
+	 * the occupied voxels
+	 */
+	void downsample(const double voxel_size, const bool with_colors,
+					PointCloud& cloud);
+
+	/// @brief (u - cx) / fx for each column of the image
+	std::vector<float> _column_factors;
+	/// @brief open addressing hash table from voxel keys to voxels
+	std::vector<VoxelCell> _voxel_table;
+	/// @brief indices of the occupied cells of the table, to reset them
+	std::vector<size_t> _occupied_cells;
+	/// @brief occupied voxels, in order of first occupation
+	std::vector<Voxel> _voxels;
+};
+
+}  // namespace SaiGraphics
+
+#endif	// SAI_GRAPHICS_POINT_CLOUD_H
@@ -0,0 +1,143 @@
+#include "Segmentation.h"
+
+#include <stdexcept>
+
+#include "chai_extension/CRobotLink.h"
+
+using namespace chai3d;
+
+namespace SaiGraphics {
+
+namespace {
+// the ids are encoded on the 24 bits of the rgb color
+const unsigned int MAX_SEGMENTATION_ID = (1u << 24) - 1;
+}  // namespace
+
+SegmentationPass::SegmentationPass()
+	: _world(NULL), _camera(NULL), _saved_shadow_casting(false) {
+	clear();
+}
+
+unsigned int SegmentationPass::addLabel(cGenericObject* root,
+										const SegmentationLabel& label) {
+	const unsigned int id = _labels.size();
+	if (id > MAX_SEGMENTATION_ID) {
+		throw std::runtime_error(
+			"too many labels in SegmentationPass::addLabel");
+	}
+	_labels.push_back(label);
+
+	// only the emission is used, so that the lights have no effect
+	cMaterialPtr id_material = cMaterial::create();
+	id_material->m_ambient.set(0.0f, 0.0f, 0.0f, 1.0f);
+	id_material->m_diffuse.set(0.0f, 0.0f, 0.0f, 1.0f);
+	id_material->m_specular.set(0.0f, 0.0f, 0.0f, 1.0f);
+	id_material->m_emission.set((id & 0xff) / 255.0f,
+								((id >> 8) & 0xff) / 255.0f,
+								((id >> 16) & 0xff) / 255.0f, 1.0f);
+	id_material->setShininess(0);
+
+	// the visuals of the root itself are added even if it is a robot link
+	_visuals.push_back(Visual{root, id_material});
+	for (unsigned int i = 0; i < root->getNumChildren(); ++i) {
+		addVisualsRecursive(root->getChild(i), id_material);
+	}
+
+	cGenericObject* world_root = root;
+	while (world_root->getParent() != NULL &&
+		   dynamic_cast<cWorld*>(world_root->getParent()) == NULL) {
+		world_root = world_root->getParent();
+	}
+	_world_roots.insert(world_root);
+	return id;
+}
+
+void SegmentationPass::addVisualsRecursive(cGenericObject* object,
+										   const cMaterialPtr& id_material) {
+	if (dynamic_cast<cRobotLink*>(object) != NULL) {
+		return;
+	}
+	_visuals.push_back(Visual{object, id_material});
+	for (unsigned int i = 0; i < object->getNumChildren(); ++i) {
+		addVisualsRecursive(object->getChild(i), id_material);
+	}
+}
+
+void SegmentationPass::clear() {
+	_labels.clear();
+	_labels.push_back(SegmentationLabel());
+	_visuals.clear();
+	_world_roots.clear();
+	_disabled_children.clear();
+	_world = NULL;
+	_camera = NULL;
+}
+
+void SegmentationPass::begin(cWorld* world, cCamera* camera) {
+	if (_world != NULL) {
+		throw std::runtime_error(
+			"SegmentationPass::begin called twice without calling end");
+	}
+	_world = world;
+	_camera = camera;
+
+	// black background for the id 0
+	_saved_background_color = _world->getBackgroundColor();
+	_world->setBackgroundColor(cColorf(0.0f, 0.0f, 0.0f, 1.0f));
+	_saved_shadow_casting = _camera->getUseShadowCasting();
+	_camera->setUseShadowCasting(false);
+
+	// disable everything that is not labeled, including the lights
+	_disabled_children.clear();
+	for (unsigned int i = 0; i < _world->getNumChildren(); ++i) {
+		cGenericObject* child = _world->getChild(i);
+		if (child->getEnabled() &&
+			_world_roots.find(child) == _world_roots.end()) {
+			child->setEnabled(false, false);
+			_disabled_children.push_back(child);
+		}
+	}
+
+	for (auto& visual : _visuals) {
+		cGenericObject* object = visual.object;
+		visual.saved_material = object->m_material;
+		visual.saved_use_material = object->getUseMaterial();
+		visual.saved_use_texture = object->getUseTexture();
+		visual.saved_use_vertex_colors = object->getUseVertexColors();
+		visual.saved_use_transparency = object->getUseTransparency();
+		visual.saved_show_frame = object->getShowFrame();
+		object->m_material = visual.id_material;
+		object->setUseMaterial(true, false);
+		object->setUseTexture(false, false);
+		object->setUseVertexColors(false, false);
+		object->setUseTransparency(false, false);
+		object->setShowFrame(false, false);
+	}
+}
+
+void SegmentationPass::end() {
+	if (_world == NULL) {
+		return;
+	}
+	for (auto& visual : _visuals) {
+		cGenericObject* object = visual.object;
+		object->m_material = visual.saved_material;
+		object->setUseMaterial(visual.saved_use_material, false);
+		object->setUseTexture(visual.saved_use_texture, false);
+		object->setUseVertexColors(visual.saved_use_vertex_colors, false);
+		object->setUseTransparency(visual.saved_use_transparency, false);
+		object->setShowFrame(visual.saved_show_frame, false);
+		// do not hold on to the material between passes
+		visual.saved_material.reset();
+	}
+	for (auto child : _disabled_children) {
+		child->setEnabled(true, false);
+	}
+	_disabled_children.clear();
+	_camera->setUseShadowCasting(_saved_shadow_casting);
+	_world->setBackgroundColor(_saved_background_color);
+	_world = NULL;
+	_camera = NULL;
+}
+
+}  // namespace SaiGraphics
@@ -0,0 +1,118 @@
+/**
+ * \file Segmentation.h
+ *
+ * \brief Rendering of segmentation images, where each robot link and object
+ * of the graphics world is drawn with a flat color encoding its id.
+ */
+
+#ifndef SAI_GRAPHICS_SEGMENTATION_H
+#define SAI_GRAPHICS_SEGMENTATION_H
+
+#include <chai3d.h>
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace SaiGraphics {
+
+/**
+ * @brief What a segmentation id corresponds to in the graphics world. The id
+ * 0 is the background (empty name).
+ */
+struct SegmentationLabel {
+	/// @brief name of the robot or object
+	std::string name;
+	/// @brief name of the robot link, empty for objects
+	std::string link_name;
+	/// @brief true for robot links, false for objects and the background
+	bool is_robot = false;
+};
+
+/**
+ * @brief Decodes the segmentation id of a pixel of a segmentation image
+ * (RGBA 8 bits per channel, the id is stored on the 24 bits of the color)
+ */
+inline unsigned int decodeSegmentationId(const unsigned char* pixel) {
+	return (unsigned int)pixel[0] | ((unsigned int)pixel[1] << 8) |
+		   ((unsigned int)pixel[2] << 16);
+}
+
+/**
+ * @brief Switches the chai world to the segmentation mode for the time of a
+ * camera rendering. Between begin and end, the registered robot links and
+ * objects are rendered with an emission only material whose color encodes
+ * their id, without textures, vertex colors or transparency, and everything
+ * else in the world (lights, cameras, widgets) is disabled, as well as the
+ * shadows of the camera. end restores the world as it was.
+ *
+ * The materials and the storage for the saved states are allocated when the
+ * labels are added, so rendering does not allocate.
+ */
+class SegmentationPass {
+public:
+	SegmentationPass();
+
+	/**
+	 * @brief Registers a robot link or an object. All its visuals are
+	 * rendered with the color of a new id, except those of child robot links
+	 * that are registered separately.
+	 *
+	 * @param root robot link or object in the chai world
+	 * @param label what the id corresponds to
+	 * @return unsigned int the id of the label
+	 */
+	unsigned int addLabel(chai3d::cGenericObject* root,
+						  const SegmentationLabel& label);
+
+	/// @brief removes all the labels
+	void clear();
+
+	/// @brief labels indexed by id, the first one is the background
+	const std::vector<SegmentationLabel>& labels() const { return _labels; }
+
+	/**
+	 * @brief Switches the world to the segmentation mode
+	 *
+	 * @param world world containing the registered objects
+	 * @param camera camera about to render the world
+	 */
+	void begin(chai3d::cWorld* world, chai3d::cCamera* camera);
+
+	/// @brief restores the world as it was before begin
+	void end();
+
+private:
+	/// @brief a registered visual and the rendering state it had before begin
+	struct Visual {
+		chai3d::cGenericObject* object;
+		/// @brief material encoding the id of the visual
+		chai3d::cMaterialPtr id_material;
+		chai3d::cMaterialPtr saved_material;
+		bool saved_use_material = false;
+		bool saved_use_texture = false;
+		bool saved_use_vertex_colors = false;
+		bool saved_use_transparency = false;
+		bool saved_show_frame = false;
+	};
+
+	/// @brief adds the visuals of a subtree, stopping at robot links
+	void addVisualsRecursive(chai3d::cGenericObject* object,
+							 const chai3d::cMaterialPtr& id_material);
+
+	std::vector<SegmentationLabel> _labels;
+	std::vector<Visual> _visuals;
+	/// @brief children of the world containing registered objects
+	std::unordered_set<chai3d::cGenericObject*> _world_roots;
+	/// @brief children of the world disabled by begin
+	std::vector<chai3d::cGenericObject*> _disabled_children;
+
+	chai3d::cWorld* _world;
+	chai3d::cCamera* _camera;
+	chai3d::cColorf _saved_background_color;
+	bool _saved_shadow_casting;
+};
+
+}  // namespace SaiGraphics
+
+#endif	// SAI_GRAPHICS_SEGMENTATION_H
@@ -0,0 +1,267 @@
+#include "SharedFrameRing.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace SaiGraphics {
+
+namespace {
+
+// "SAIF" in little endian, written last by the writer once the ring is ready
+const uint32_t RING_MAGIC = 0x46494153;
+const uint32_t RING_VERSION = 1;
+const size_t CACHE_LINE_SIZE = 64;
+// maximum number of attempts to find a frame that is not being overwritten
+const int MAX_READ_ATTEMPTS = 16;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+			  "the sequence numbers need lock free atomics to be shared "
+			  "between processes");
+
+// header at the start of the segment
+struct alignas(CACHE_LINE_SIZE) RingHeader {
+	std::atomic<uint32_t> magic;
+	uint32_t version;
+	uint32_t num_slots;
+	uint32_t slot_stride;
+	uint64_t slot_capacity;
+	std::atomic<uint64_t> latest_frame;
+};
+
+// header of each slot, followed by the pixels
+struct alignas(CACHE_LINE_SIZE) SlotHeader {
+	// odd while the frame is written, 2 * frame_number once complete
+	std::atomic<uint64_t> sequence;
+	SharedFrameInfo info;
+};
+
+size_t alignToCacheLine(const size_t size) {
+	return (size + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+}
+
+std::string segmentName(const std::string& name) {
+	return (!name.empty() && name[0] == '/') ? name : "/" + name;
+}
+
+RingHeader* ringHeader(unsigned char* segment) {
+	return reinterpret_cast<RingHeader*>(segment);
+}
+
+const RingHeader* ringHeader(const unsigned char* segment) {
+	return reinterpret_cast<const RingHeader*>(segment);
+}
+
+size_t slotOffset(const RingHeader* header, const uint32_t slot) {
+	return sizeof(RingHeader) + (size_t)slot * header->slot_stride;
+}
+
+SlotHeader* slotHeader(unsigned char* segment, const uint32_t slot) {
+	return reinterpret_cast<SlotHeader*>(
+		segment + slotOffset(ringHeader(segment), slot));
+}
+
+const SlotHeader* slotHeader(const unsigned char* segment,
+							 const uint32_t slot) {
+	return reinterpret_cast<const SlotHeader*>(
+		segment + slotOffset(ringHeader(segment), slot));
+}
+
+}  // namespace
+
+SharedFrameWriter::SharedFrameWriter(const std::string& name,
+									 const unsigned int num_slots,
+									 const size_t slot_capacity)
+	: _name(segmentName(name)),
+	  _num_slots(num_slots),
+	  _slot_capacity(slot_capacity),
+	  _segment(NULL),
+	  _frame_number(0),
+	  _writing(false) {
+	if (num_slots == 0 || slot_capacity == 0) {
+		throw std::invalid_argument(
+			"number of slots and slot capacity should be positive in "
+			"SharedFrameWriter");
+	}
+	const size_t slot_stride =
+		alignToCacheLine(sizeof(SlotHeader) + slot_capacity);
+	_segment_size = sizeof(RingHeader) + num_slots * slot_stride;
+
+	// a segment left by a previous writer is replaced
+	shm_unlink(_name.c_str());
+	const int fd = shm_open(_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+	if (fd < 0) {
+		throw std::runtime_error("could not create shared memory " + _name);
+	}
+	if (ftruncate(fd, _segment_size) != 0) {
+		close(fd);
+		shm_unlink(_name.c_str());
+		throw std::runtime_error("could not size shared memory " + _name);
+	}
+	void* segment = mmap(NULL, _segment_size, PROT_READ | PROT_WRITE,
+						 MAP_SHARED, fd, 0);
+	close(fd);
+	if (segment == MAP_FAILED) {
+		shm_unlink(_name.c_str());
+		throw std::runtime_error("could not map shared memory " + _name);
+	}
+	_segment = static_cast<unsigned char*>(segment);
+
+	// the segment is zero filled, so all the slots start empty
+	RingHeader* header = new (_segment) RingHeader;
+	header->version = RING_VERSION;
+	header->num_slots = num_slots;
+	header->slot_stride = slot_stride;
+	header->slot_capacity = slot_capacity;
+	header->latest_frame.store(0, std::memory_order_relaxed);
+	for (unsigned int i = 0; i < num_slots; ++i) {
+		SlotHeader* slot = new (_segment + slotOffset(header, i)) SlotHeader;
+		slot->sequence.store(0, std::memory_order_relaxed);
+	}
+	header->magic.store(RING_MAGIC, std::memory_order_release);
+}
+
+SharedFrameWriter::~SharedFrameWriter() {
+	munmap(_segment, _segment_size);
+	shm_unlink(_name.c_str());
+}
+
+unsigned char* SharedFrameWriter::beginFrame(const uint32_t width,
+											 const uint32_t height,
+											 const uint32_t format,
+											 const double timestamp) {
+	if (format != SharedFrameInfo::RGBA8) {
+		throw std::invalid_argument(
+			"unsupported pixel format in SharedFrameWriter::beginFrame");
+	}
+	const uint32_t row_stride = 4 * width;
+	if ((size_t)row_stride * height > _slot_capacity) {
+		return NULL;
+	}
+	// a frame that was begun but not ended is overwritten
+	if (!_writing) {
+		++_frame_number;
+	}
+	_writing = true;
+
+	SlotHeader* slot = slotHeader(_segment, (_frame_number - 1) % _num_slots);
+	slot->sequence.store(2 * _frame_number - 1, std::memory_order_relaxed);
+	// the odd sequence is visible before any of the writes below
+	std::atomic_thread_fence(std::memory_order_release);
+	slot->info.width = width;
+	slot->info.height = height;
+	slot->info.format = format;
+	slot->info.row_stride = row_stride;
+	slot->info.frame_number = _frame_number;
+	slot->info.timestamp = timestamp;
+	// the pixels follow the slot header
+	return reinterpret_cast<unsigned char*>(slot + 1);
+}
+
+void SharedFrameWriter::endFrame() {
+	if (!_writing) {
+		return;
+	}
+	_writing = false;
+	SlotHeader* slot = slotHeader(_segment, (_frame_number - 1) % _num_slots);
+	slot->sequence.store(2 * _frame_number, std::memory_order_release);
+	ringHeader(_segment)->latest_frame.store(_frame_number,
+											 std::memory_order_release);
+}
+
+SharedFrameReader::SharedFrameReader(const std::string& name)
+	: _name(segmentName(name)), _segment_size(0), _segment(NULL) {
+	const int fd = shm_open(_name.c_str(), O_RDONLY, 0);
+	if (fd < 0) {
+		throw std::runtime_error("could not open shared memory " + _name);
+	}
+	struct stat segment_stat;
+	if (fstat(fd, &segment_stat) != 0 ||
+		(size_t)segment_stat.st_size < sizeof(RingHeader)) {
+		close(fd);
+		throw std::runtime_error("invalid shared memory " + _name);
+	}
+	_segment_size = segment_stat.st_size;
+	void* segment = mmap(NULL, _segment_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (segment == MAP_FAILED) {
+		throw std::runtime_error("could not map shared memory " + _name);
+	}
+	_segment = static_cast<const unsigned char*>(segment);
+
+	const RingHeader* header = ringHeader(_segment);
+	if (header->magic.load(std::memory_order_acquire) != RING_MAGIC ||
+		header->version != RING_VERSION ||
+		slotOffset(header, header->num_slots) > _segment_size) {
+		munmap(const_cast<unsigned char*>(_segment), _segment_size);
+		throw std::runtime_error("shared memory " + _name +
+								 " is not a frame ring or is not ready");
+	}
+}
+
+SharedFrameReader::~SharedFrameReader() {
+	munmap(const_cast<unsigned char*>(_segment), _segment_size);
+}
+
+uint64_t SharedFrameReader::latestFrameNumber() const {
+	return ringHeader(_segment)->latest_frame.load(std::memory_order_acquire);
+}
+
+bool SharedFrameReader::acquireLatestFrame(SharedFrameView& view) const {
+	const RingHeader* header = ringHeader(_segment);
+	for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; ++attempt) {
+		const uint64_t frame_number = latestFrameNumber();
+		if (frame_number == 0) {
+			return false;
+		}
+		const uint32_t slot_index = (frame_number - 1) % header->num_slots;
+		const SlotHeader* slot = slotHeader(_segment, slot_index);
+		const uint64_t sequence =
+			slot->sequence.load(std::memory_order_acquire);
+		// otherwise the writer already reuses the slot for a newer frame
+		if (sequence == 2 * frame_number) {
+			view.info = slot->info;
+			view.data = reinterpret_cast<const unsigned char*>(slot + 1);
+			view.sequence = sequence;
+			view.slot = slot_index;
+			if (isFrameValid(view)) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+bool SharedFrameReader::isFrameValid(const SharedFrameView& view) const {
+	const SlotHeader* slot = slotHeader(_segment, view.slot);
+	// the reads of the frame complete before the sequence is read again
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return view.data != NULL &&
+		   slot->sequence.load(std::memory_order_relaxed) == view.sequence;
+}
+
+bool SharedFrameReader::copyLatestFrame(std::vector<unsigned char>& data,
+										SharedFrameInfo& info) const {
+	SharedFrameView view;
+	for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; ++attempt) {
+		if (!acquireLatestFrame(view)) {
+			return false;
+		}
+		const size_t size = (size_t)view.info.row_stride * view.info.height;
+		data.resize(size);
+		memcpy(data.data(), view.data, size);
+		if (isFrameValid(view)) {
+			info = view.info;
+			return true;
+		}
+	}
+	return false;
+}
+
+}  // namespace SaiGraphics
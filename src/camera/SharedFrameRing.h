@@ -0,0 +1,183 @@
+/**
+ * \file SharedFrameRing.h
+ *
+ * \brief Ring buffer of image frames in POSIX shared memory, used to publish
+ * camera images to other processes without copies. This file and
+ * SharedFrameRing.cpp only depend on POSIX, so that reader processes can use
+ * them without linking against the rest of the library.
+ */
+
+#ifndef SAI_GRAPHICS_SHARED_FRAME_RING_H
+#define SAI_GRAPHICS_SHARED_FRAME_RING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SaiGraphics {
+
+/// @brief description of a frame of the ring
+struct SharedFrameInfo {
+	/// @brief pixel formats of the frames
+	enum Format {
+		/// @brief RGBA 8 bits per channel
+		RGBA8 = 0
+	};
+
+	/// @brief size of the image in pixels
+	uint32_t width = 0;
+	uint32_t height = 0;
+	/// @brief pixel format (one of Format)
+	uint32_t format = RGBA8;
+	/// @brief size of a row of pixels in bytes. The rows are stored from the
+	/// bottom row of the image to the top one, as read from OpenGL
+	uint32_t row_stride = 0;
+	/// @brief number of the frame since the ring was created, starting at 1
+	uint64_t frame_number = 0;
+	/// @brief simulation time of the frame in seconds (see
+	/// SaiGraphics::setSimulationTime)
+	double timestamp = 0.0;
+};
+
+/**
+ * @brief Frame of a reader mapped directly in shared memory. The writer may
+ * overwrite it at any time, so the data should be checked with
+ * SharedFrameReader::isFrameValid after being used.
+ */
+struct SharedFrameView {
+	SharedFrameInfo info;
+	/// @brief pixels of the frame, info.height rows of info.row_stride bytes
+	const unsigned char* data = NULL;
+	/// @brief sequence number of the slot when the view was acquired
+	uint64_t sequence = 0;
+	/// @brief slot of the ring containing the frame
+	uint32_t slot = 0;
+};
+
+/**
+ * @brief Writer side of the ring. It creates the shared memory segment
+ * (replacing any segment with the same name) and removes it when destroyed.
+ *
+ * Each slot is protected by a sequence lock: its sequence number is odd while
+ * the frame is written and even once it is complete, so readers never block
+ * the writer and detect frames that were overwritten while they read them.
+ */
+class SharedFrameWriter {
+public:
+	/**
+	 * @brief Creates the shared memory segment
+	 *
+	 * @param name name of the segment (a leading / is added if missing)
+	 * @param num_slots number of frames in the ring
+	 * @param slot_capacity maximum size of the pixels of a frame in bytes
+	 */
+	SharedFrameWriter(const std::string& name, const unsigned int num_slots,
+					  const size_t slot_capacity);
+
+	/**
+	 * @brief Unmaps and removes the segment. Readers that still have it mapped
+	 * keep their mapping.
+	 *
+	 */
+	~SharedFrameWriter();
+
+	SharedFrameWriter(const SharedFrameWriter&) = delete;
+	SharedFrameWriter& operator=(const SharedFrameWriter&) = delete;
+
+	/**
+	 * @brief Starts writing the next frame of the ring and returns the memory
+	 * in which its pixels should be written, before calling endFrame. Returns
+	 * NULL if the frame does not fit in a slot, and throws if the format is not
+	 * supported.
+	 *
+	 * @param width width of the image in pixels
+	 * @param height height of the image in pixels
+	 * @param format pixel format (SharedFrameInfo::Format)
+	 * @param timestamp simulation time of the frame
+	 */
+	unsigned char* beginFrame(const uint32_t width, const uint32_t height,
+							  const uint32_t format, const double timestamp);
+
+	/// @brief publishes the frame started with beginFrame
+	void endFrame();
+
+	/// @brief name of the shared memory segment
+	const std::string& name() const { return _name; }
+
+	/// @brief maximum size of the pixels of a frame in bytes
+	size_t slotCapacity() const { return _slot_capacity; }
+
+	/// @brief number of frames published so far
+	uint64_t numFramesPublished() const { return _frame_number; }
+
+private:
+	std::string _name;
+	unsigned int _num_slots;
+	size_t _slot_capacity;
+	size_t _segment_size;
+	unsigned char* _segment;
+	/// @brief number of the last frame started
+	uint64_t _frame_number;
+	/// @brief true between beginFrame and endFrame
+	bool _writing;
+};
+
+/**
+ * @brief Reader side of the ring, usable from any process. Frames can be
+ * accessed in place (zero copy) or copied.
+ */
+class SharedFrameReader {
+public:
+	/**
+	 * @brief Maps an existing ring. Throws if it does not exist.
+	 *
+	 * @param name name of the segment given to the writer
+	 */
+	explicit SharedFrameReader(const std::string& name);
+
+	/**
+	 * @brief Unmaps the segment
+	 *
+	 */
+	~SharedFrameReader();
+
+	SharedFrameReader(const SharedFrameReader&) = delete;
+	SharedFrameReader& operator=(const SharedFrameReader&) = delete;
+
+	/// @brief number of the latest complete frame, 0 if there is none
+	uint64_t latestFrameNumber() const;
+
+	/**
+	 * @brief Gives access in place to the latest complete frame
+	 *
+	 * @param view view of the frame
+	 * @return false if there is no frame yet
+	 */
+	bool acquireLatestFrame(SharedFrameView& view) const;
+
+	/**
+	 * @brief Returns true if the frame of a view was not overwritten since the
+	 * view was acquired, i.e. if the data read through the view is consistent
+	 */
+	bool isFrameValid(const SharedFrameView& view) const;
+
+	/**
+	 * @brief Copies the latest complete frame
+	 *
+	 * @param data pixels of the frame, resized if needed
+	 * @param info description of the frame
+	 * @return false if there is no frame yet
+	 */
+	bool copyLatestFrame(std::vector<unsigned char>& data,
+						 SharedFrameInfo& info) const;
+
+private:
+	std::string _name;
+	size_t _segment_size;
+	const unsigned char* _segment;
+};
+
+}  // namespace SaiGraphics
+
+#endif	// SAI_GRAPHICS_SHARED_FRAME_RING_H
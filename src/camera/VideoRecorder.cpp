@@ -0,0 +1,277 @@
+#include "VideoRecorder.h"
+
+#include <pthread.h>
+#include <signal.h>
+
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace SaiGraphics {
+
+namespace {
+// bytes per pixel of the captured frames
+const int PIXEL_SIZE = 4;
+
+// quotes a path for the shell
+string shellQuote(const string& path) {
+	string quoted = "'";
+	for (const char c : path) {
+		if (c == '\'') {
+			quoted += "'\\''";
+		} else {
+			quoted += c;
+		}
+	}
+	return quoted + "'";
+}
+
+// discards a SIGPIPE raised by a failed write of the calling thread, in which
+// it is blocked
+void clearPendingSigpipe() {
+	sigset_t sigpipe_set;
+	sigemptyset(&sigpipe_set);
+	sigaddset(&sigpipe_set, SIGPIPE);
+	const struct timespec no_wait = {0, 0};
+	while (sigtimedwait(&sigpipe_set, NULL, &no_wait) == SIGPIPE) {
+	}
+}
+}  // namespace
+
+VideoRecorder::VideoRecorder(const string& path, const int width,
+							 const int height, const double fps,
+							 const Format format,
+							 const unsigned int num_buffers)
+	: _width(width),
+	  _height(height),
+	  _fps(fps),
+	  _format(format),
+	  _file(NULL),
+	  _queue_head(0),
+	  _queue_size(0),
+	  _acquired_frame(-1),
+	  _stop_requested(false),
+	  _frames_captured(0),
+	  _frames_written(0),
+	  _frames_dropped(0),
+	  _write_failed(false) {
+	if (width <= 0 || height <= 0 || fps <= 0 || num_buffers == 0) {
+		throw invalid_argument(
+			"image size, frame rate and number of buffers should be positive "
+			"in VideoRecorder");
+	}
+	// the frame rate is stored as a fraction with a denominator of 1000
+	const long fps_numerator = lround(fps * 1000);
+
+	switch (format) {
+		case Y4M: {
+			_file = fopen(path.c_str(), "wb");
+			if (_file == NULL) {
+				throw runtime_error("could not open video file " + path);
+			}
+			fprintf(_file, "YUV4MPEG2 W%d H%d F%ld:1000 Ip A1:1 C444\n", width,
+					height, fps_numerator);
+			_encoded_frame.resize(3 * (size_t)width * height);
+			break;
+		}
+		case RawRGB: {
+			_file = fopen(path.c_str(), "wb");
+			if (_file == NULL) {
+				throw runtime_error("could not open video file " + path);
+			}
+			_encoded_frame.resize(3 * (size_t)width * height);
+			break;
+		}
+		case MJPEG: {
+			if (!isMJPEGAvailable()) {
+				throw runtime_error(
+					"MJPEG recording needs ffmpeg, which was not found");
+			}
+			// ffmpeg flips the frames, they are piped as captured
+			stringstream command;
+			command << "ffmpeg -loglevel error -y -f rawvideo -pix_fmt rgba"
+					<< " -s " << width << "x" << height << " -r "
+					<< fps_numerator << "/1000 -i - -vf vflip -c:v mjpeg"
+					<< " -q:v 3 " << shellQuote(path);
+			_file = popen(command.str().c_str(), "w");
+			if (_file == NULL) {
+				throw runtime_error("could not start ffmpeg to record " + path);
+			}
+			break;
+		}
+		default:
+			throw invalid_argument("unknown format in VideoRecorder");
+	}
+
+	const size_t frame_size = (size_t)width * height * PIXEL_SIZE;
+	_frames.assign(num_buffers, vector<unsigned char>(frame_size));
+	_queued_frames.resize(num_buffers);
+	_free_frames.reserve(num_buffers);
+	for (unsigned int i = 0; i < num_buffers; ++i) {
+		_free_frames.push_back(num_buffers - 1 - i);
+	}
+	_encoder_thread = thread(&VideoRecorder::encoderLoop, this);
+}
+
+VideoRecorder::~VideoRecorder() { stop(); }
+
+unsigned char* VideoRecorder::acquireFrame() {
+	++_frames_captured;
+	lock_guard<mutex> lock(_mutex);
+	if (_stop_requested || _write_failed || _acquired_frame >= 0 ||
+		_free_frames.empty()) {
+		++_frames_dropped;
+		return NULL;
+	}
+	_acquired_frame = _free_frames.back();
+	_free_frames.pop_back();
+	return _frames[_acquired_frame].data();
+}
+
+void VideoRecorder::submitFrame() {
+	{
+		lock_guard<mutex> lock(_mutex);
+		if (_acquired_frame < 0) {
+			return;
+		}
+		_queued_frames[(_queue_head + _queue_size) % _queued_frames.size()] =
+			_acquired_frame;
+		++_queue_size;
+		_acquired_frame = -1;
+	}
+	_queue_cv.notify_one();
+}
+
+void VideoRecorder::stop() {
+	{
+		lock_guard<mutex> lock(_mutex);
+		if (_stop_requested) {
+			return;
+		}
+		_stop_requested = true;
+	}
+	_queue_cv.notify_one();
+	if (_encoder_thread.joinable()) {
+		_encoder_thread.join();
+	}
+}
+
+bool VideoRecorder::isMJPEGAvailable() {
+	return system("ffmpeg -version > /dev/null 2>&1") == 0;
+}
+
+VideoRecorder::Statistics VideoRecorder::getStatistics() const {
+	Statistics statistics;
+	statistics.frames_captured = _frames_captured;
+	statistics.frames_written = _frames_written;
+	statistics.frames_dropped = _frames_dropped;
+	statistics.write_failed = _write_failed;
+	return statistics;
+}
+
+void VideoRecorder::encoderLoop() {
+	// if ffmpeg exits early, writing to its pipe raises SIGPIPE, which would
+	// kill the application. With the signal blocked in this thread, the write
+	// fails with EPIPE instead and the recording stops
+	sigset_t sigpipe_set;
+	sigemptyset(&sigpipe_set);
+	sigaddset(&sigpipe_set, SIGPIPE);
+	pthread_sigmask(SIG_BLOCK, &sigpipe_set, NULL);
+
+	while (true) {
+		unsigned int frame_index;
+		{
+			unique_lock<mutex> lock(_mutex);
+			_queue_cv.wait(lock, [this] {
+				return _queue_size > 0 || _stop_requested;
+			});
+			// the queued frames are written before stopping
+			if (_queue_size == 0) {
+				break;
+			}
+			frame_index = _queued_frames[_queue_head];
+			_queue_head = (_queue_head + 1) % _queued_frames.size();
+			--_queue_size;
+		}
+
+		if (!_write_failed) {
+			if (writeFrame(_frames[frame_index].data())) {
+				++_frames_written;
+			} else {
+				if (errno == EPIPE) {
+					clearPendingSigpipe();
+				}
+				_write_failed = true;
+				cout << "WARNING: failed to write video frame, the following "
+						"frames are dropped"
+					 << endl;
+			}
+		}
+		if (_write_failed) {
+			++_frames_dropped;
+		}
+
+		lock_guard<mutex> lock(_mutex);
+		_free_frames.push_back(frame_index);
+	}
+	closeFile();
+}
+
+void VideoRecorder::closeFile() {
+	// closing flushes the buffered data, which can also fail on a closed pipe
+	if (_format == MJPEG) {
+		pclose(_file);
+	} else {
+		fclose(_file);
+	}
+	_file = NULL;
+	clearPendingSigpipe();
+}
+
+bool VideoRecorder::writeFrame(const unsigned char* rgba) {
+	const size_t num_pixels = (size_t)_width * _height;
+	if (_format == MJPEG) {
+		return fwrite(rgba, PIXEL_SIZE, num_pixels, _file) == num_pixels;
+	}
+
+	// the frames are stored top row first
+	unsigned char* out = _encoded_frame.data();
+	for (int v = 0; v < _height; ++v) {
+		const unsigned char* row =
+			rgba + (size_t)(_height - 1 - v) * _width * PIXEL_SIZE;
+		if (_format == RawRGB) {
+			unsigned char* out_row = out + (size_t)v * _width * 3;
+			for (int u = 0; u < _width; ++u) {
+				out_row[3 * u] = row[PIXEL_SIZE * u];
+				out_row[3 * u + 1] = row[PIXEL_SIZE * u + 1];
+				out_row[3 * u + 2] = row[PIXEL_SIZE * u + 2];
+			}
+			continue;
+		}
+		// planar YUV with the BT.601 limited range coefficients
+		unsigned char* y_row = out + (size_t)v * _width;
+		unsigned char* u_row = y_row + num_pixels;
+		unsigned char* v_row = u_row + num_pixels;
+		for (int u = 0; u < _width; ++u) {
+			const int r = row[PIXEL_SIZE * u];
+			const int g = row[PIXEL_SIZE * u + 1];
+			const int b = row[PIXEL_SIZE * u + 2];
+			y_row[u] = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+			u_row[u] = ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128;
+			v_row[u] = ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128;
+		}
+	}
+
+	if (_format == Y4M && fputs("FRAME\n", _file) < 0) {
+		return false;
+	}
+	return fwrite(out, 1, _encoded_frame.size(), _file) ==
+		   _encoded_frame.size();
+}
+
+}  // namespace SaiGraphics
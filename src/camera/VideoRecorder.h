@@ -0,0 +1,157 @@
+/**
+ * \file VideoRecorder.h
+ *
+ * \brief Recording of camera images to a video file, encoded and written by a
+ * background thread.
+ */
+
+#ifndef SAI_GRAPHICS_VIDEO_RECORDER_H
+#define SAI_GRAPHICS_VIDEO_RECORDER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace SaiGraphics {
+
+/**
+ * @brief Writes frames to a video file from a background thread. The frames
+ * are written in a fixed pool of buffers and queued for the encoder thread. If
+ * the encoder falls behind and all the buffers are in the queue, new frames are
+ * dropped (and counted) instead of blocking the caller.
+ *
+ * The frames are RGBA images, 8 bits per channel, bottom row first (as read
+ * from OpenGL). They are flipped when encoded.
+ */
+class VideoRecorder {
+public:
+	/// @brief file formats of the videos
+	enum Format {
+		/// @brief uncompressed YUV 4:4:4 in a YUV4MPEG2 stream, readable by
+		/// most video tools (ffmpeg, mpv, vlc...)
+		Y4M = 0,
+		/// @brief raw RGB 24 bits frames, top row first, without header
+		RawRGB,
+		/// @brief motion JPEG encoded by a local ffmpeg executable
+		MJPEG
+	};
+
+	/// @brief counters of a recording
+	struct Statistics {
+		/// @brief frames given to the recorder, including the dropped ones
+		unsigned long long frames_captured = 0;
+		/// @brief frames written to the file
+		unsigned long long frames_written = 0;
+		/// @brief frames dropped because the encoder was behind, or because
+		/// writing the file failed
+		unsigned long long frames_dropped = 0;
+		/// @brief true if writing the file failed (full disk, ffmpeg
+		/// exited...), in which case the following frames are dropped
+		bool write_failed = false;
+	};
+
+	/**
+	 * @brief Opens the video file and starts the encoder thread
+	 *
+	 * @param path path of the video file (overwritten if it exists)
+	 * @param width width of the frames in pixels
+	 * @param height height of the frames in pixels
+	 * @param fps frame rate stored in the video
+	 * @param format format of the video
+	 * @param num_buffers number of frames that can wait for the encoder
+	 */
+	VideoRecorder(const std::string& path, const int width, const int height,
+				  const double fps, const Format format = Y4M,
+				  const unsigned int num_buffers = 8);
+
+	/**
+	 * @brief Stops the recording if it was not stopped already
+	 *
+	 */
+	~VideoRecorder();
+
+	VideoRecorder(const VideoRecorder&) = delete;
+	VideoRecorder& operator=(const VideoRecorder&) = delete;
+
+	/**
+	 * @brief Reserves the buffer of the next frame. It must be filled with
+	 * width * height RGBA pixels and handed to the encoder with submitFrame.
+	 * Returns NULL, and counts a dropped frame, if all the buffers are waiting
+	 * for the encoder.
+	 */
+	unsigned char* acquireFrame();
+
+	/// @brief queues the frame returned by the last acquireFrame
+	void submitFrame();
+
+	/**
+	 * @brief Writes the frames still in the queue, stops the encoder thread
+	 * and closes the file. Nothing can be recorded afterwards.
+	 */
+	void stop();
+
+	/// @brief returns true if the MJPEG format is available (ffmpeg found)
+	static bool isMJPEGAvailable();
+
+	/// @brief counters of the recording
+	Statistics getStatistics() const;
+
+	int width() const { return _width; }
+	int height() const { return _height; }
+	double fps() const { return _fps; }
+
+private:
+	/// @brief main loop of the encoder thread. It closes the file when the
+	/// recording stops
+	void encoderLoop();
+
+	/// @brief closes the file, from the encoder thread
+	void closeFile();
+
+	/// @brief writes one frame to the file, returns false on error
+	bool writeFrame(const unsigned char* rgba);
+
+	const int _width;
+	const int _height;
+	const double _fps;
+	const Format _format;
+
+	/// @brief output file, or pipe to ffmpeg for MJPEG
+	FILE* _file;
+	/// @brief encoded frame (converted and flipped)
+	std::vector<unsigned char> _encoded_frame;
+
+	/// @brief frame buffers
+	std::vector<std::vector<unsigned char>> _frames;
+	/// @brief indices of the buffers that can be acquired
+	std::vector<unsigned int> _free_frames;
+	/// @brief ring of the indices of the buffers waiting for the encoder
+	std::vector<unsigned int> _queued_frames;
+	/// @brief position of the oldest queued buffer in the ring and number of
+	/// queued buffers
+	size_t _queue_head;
+	size_t _queue_size;
+	/// @brief buffer returned by acquireFrame, -1 if none
+	int _acquired_frame;
+
+	/// @brief protects the buffer lists
+	std::mutex _mutex;
+	/// @brief signals the encoder thread that frames are queued or that the
+	/// recording stops
+	std::condition_variable _queue_cv;
+	bool _stop_requested;
+	std::thread _encoder_thread;
+
+	std::atomic<unsigned long long> _frames_captured;
+	std::atomic<unsigned long long> _frames_written;
+	std::atomic<unsigned long long> _frames_dropped;
+	std::atomic<bool> _write_failed;
+};
+
+}  // namespace SaiGraphics
+
+#endif	// SAI_GRAPHICS_VIDEO_RECORDER_H
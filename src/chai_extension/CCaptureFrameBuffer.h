@@ -0,0 +1,53 @@
+/**
+ * \file CCaptureFrameBuffer.h
+ *
+ * \brief This file is part of the extended chai functionality. It gives access
+ * to the frame buffer object of a chai frame buffer so that its content can be
+ * read directly with OpenGL (asynchronously, or into external memory).
+ */
+
+#ifndef CCaptureFrameBufferH
+#define CCaptureFrameBufferH
+
+#include "chai3d.h"
+
+namespace chai3d {
+
+class cCaptureFrameBuffer;
+typedef std::shared_ptr<cCaptureFrameBuffer> cCaptureFrameBufferPtr;
+
+class cCaptureFrameBuffer : public cFrameBuffer {
+public:
+	/**
+	 * @brief Creates a cCaptureFrameBuffer object. It behaves exactly like a
+	 * cFrameBuffer and additionally exposes its OpenGL frame buffer object.
+	 */
+	cCaptureFrameBuffer() {}
+
+	/// @brief shared pointer allocation function
+	static cCaptureFrameBufferPtr create() {
+		return std::make_shared<cCaptureFrameBuffer>();
+	}
+
+	/// @brief returns the OpenGL frame buffer object the view is rendered to
+	GLuint getFrameBufferObject() const { return m_fbo; }
+
+	/**
+	 * @brief Binds the frame buffer object for reading, so that glReadPixels
+	 * reads the last rendered view (color attachment). Call unbindForReading
+	 * when done.
+	 */
+	void bindForReading() const {
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo);
+		glReadBuffer(GL_COLOR_ATTACHMENT0);
+	}
+
+	/// @brief restores the default read frame buffer
+	static void unbindForReading() {
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	}
+};
+
+}  // namespace chai3d
+
+#endif	// CCaptureFrameBufferH
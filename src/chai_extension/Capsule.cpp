@@ -85,6 +85,14 @@ cCapsule::cCapsule(double radius, double length, double mesh_scale,
 	m_material->m_ambient.set((float)0.3, (float)0.3, (float)0.3);
 	m_material->m_diffuse.set((float)0.1, (float)0.7, (float)0.8);
 	m_material->m_specular.set((float)1.0, (float)1.0, (float)1.0);
+
+	// triangles, rendered from the same vertex buffers at every frame
+	std::shared_ptr<cPrimitiveGeometry> geometry =
+		std::make_shared<cPrimitiveGeometry>();
+	cBuildCapsuleGeometry(*geometry, _radius, _length,
+						  _num_longitudinal_slices,
+						  _num_circumferential_slices);
+	_geometry = geometry;
 }
 
 // dtor
@@ -92,18 +100,22 @@ cCapsule::~cCapsule() {
 	// nothing to do
 }
 
+// boundary box, the capsule extends by its radius around its line segment
+void cCapsule::updateBoundaryBox() {
+	m_boundaryBoxMin.set(-_radius, -_radius, -_radius);
+	m_boundaryBoxMax.set(_length + _radius, _radius, _radius);
+	m_boundaryBoxEmpty = false;
+}
+
+// re-upload the vertex buffers, e.g. for a new OpenGL context
+void cCapsule::markForUpdate(const bool a_affectChildren) {
+	cGenericObject::markForUpdate(a_affectChildren);
+	_buffers.markForUpdate();
+}
+
 // render
 void cCapsule::render(cRenderOptions& a_options) {
 #ifdef C_USE_OPENGL
-	static Vector3d point1, point2, point3, point4;
-	static PointPolar spoint1, spoint2, spoint3, spoint4;
-	static Vector3d normal1, normal2, normal3, normal4;
-	//^ NOTE: point 1 and point 2 lie on the current plane
-	// point 3 and 4 lie on the next plane
-	// point 1 and 3 lie on the current angle
-	// point 2 and 4 lie on the next angle
-	// NOTE: we are using per vertex normal
-
 	/////////////////////////////////////////////////////////////////////////
 	// ENABLE SHADER
 	/////////////////////////////////////////////////////////////////////////
@@ -125,113 +137,8 @@ void cCapsule::render(cRenderOptions& a_options) {
 			// create display list if requested
 			m_displayList.begin(m_useDisplayList);
 
-			// compute spacing parameters
-			double _ds_longitudinal = _length / (_num_longitudinal_slices - 1);
-			double _ds_longitudinal_cap = _ds_longitudinal / 3.0;
-			double _ds_angle = 2.0 * M_PI / _num_circumferential_slices;
-
-			uint nv_endcap_offset =
-				max((uint)10, uint(_radius / _ds_longitudinal_cap) + (uint)1);
-			_ds_longitudinal_cap = _radius / (nv_endcap_offset - 1);
-			uint nv_long_wendcaps =
-				_num_longitudinal_slices + nv_endcap_offset * 2;
-
-			double s_i, s_ip1, t_i, t_ip1;
-			// cout << "_ds_longitudinal " << _ds_longitudinal << "
-			// _ds_longitudinal_cap: " << _ds_longitudinal_cap << endl; cout <<
-			// "_num_longitudinal_slices " << _num_longitudinal_slices << "
-			// nv_endcap_offset: " << nv_endcap_offset << " nv_long_wendcaps: "
-			// << nv_long_wendcaps << endl;
-			for (uint i = 0; i < (nv_long_wendcaps - 1); i++) {
-				// i = index of current cross section plane
-				// j = index of current vertex along the plane
-				if (i < nv_endcap_offset) {
-					s_i = ((double)i) * _ds_longitudinal_cap - _radius;
-				} else if (i >
-						   (nv_endcap_offset + _num_longitudinal_slices - 1)) {
-					s_i = ((double)(i - nv_endcap_offset -
-									_num_longitudinal_slices)) *
-							  _ds_longitudinal_cap +
-						  _length;
-				} else {
-					s_i = ((double)(i - nv_endcap_offset)) * _ds_longitudinal;
-				}
-				if (i + 1 < nv_endcap_offset) {
-					s_ip1 = ((double)i + 1) * _ds_longitudinal_cap - _radius;
-				} else if (i + 1 >
-						   (nv_endcap_offset + _num_longitudinal_slices - 1)) {
-					s_ip1 = ((double)(i + 1 - nv_endcap_offset -
-									  _num_longitudinal_slices)) *
-								_ds_longitudinal_cap +
-							_length;
-				} else {
-					s_ip1 =
-						((double)(i + 1 - nv_endcap_offset)) * _ds_longitudinal;
-				}
-				s_ip1 = min(s_ip1, _length + _radius);
-
-				// cout << "i: " << i << " s_i: " << s_i << " s_ip1 " << s_ip1
-				// << endl;
-				t_i = radius(s_i);
-				t_ip1 = radius(s_ip1);
-
-				for (uint j = 0; j < (_num_circumferential_slices); j++) {
-					// get spatial locations of the four corners in the local
-					// frame. t != 0, eta = 0 => on the y-axis
-					spoint1 = PointPolar(/* s */ s_i, /* t */ t_i,
-										 /* eta */ ((double)j) * _ds_angle);
-					cartesianPoint(point1, spoint1);
-					normal(normal1, spoint1);
-					spoint3 = PointPolar(/* s */ s_ip1, /* t */ t_ip1,
-										 /* eta */ ((double)j) * _ds_angle);
-					cartesianPoint(point3, spoint3);
-					normal(normal3, spoint3);
-					if (j == (_num_circumferential_slices - 1)) {
-						// wrap around. so point 2 and 4 are on zero angle again
-						spoint2 =
-							PointPolar(/* s */ s_i, /* t */ t_i, /* eta */ 0.0);
-						cartesianPoint(point2, spoint2);
-						normal(normal2, spoint2);
-						spoint4 = PointPolar(/* s */ s_ip1, /* t */ t_ip1,
-											 /* eta */ 0.0);
-						cartesianPoint(point4, spoint4);
-						normal(normal4, spoint4);
-					} else {
-						spoint2 =
-							PointPolar(/* s */ s_i, /* t */ t_i,
-									   /* eta */ ((double)j + 1) * _ds_angle);
-						cartesianPoint(point2, spoint2);
-						normal(normal2, spoint2);
-						spoint4 =
-							PointPolar(/* s */ s_ip1, /* t */ t_ip1,
-									   /* eta */ ((double)j + 1) * _ds_angle);
-						cartesianPoint(point4, spoint4);
-						normal(normal4, spoint4);
-					}
-
-					// add triangle 1
-					// - add vertices and per-vertex normals
-					glBegin(GL_POLYGON);
-					glNormal3d(normal1[0], normal1[1], normal1[2]);
-					glVertex3d(point1[0], point1[1], point1[2]);
-					glNormal3d(normal2[0], normal2[1], normal2[2]);
-					glVertex3d(point2[0], point2[1], point2[2]);
-					glNormal3d(normal3[0], normal3[1], normal3[2]);
-					glVertex3d(point3[0], point3[1], point3[2]);
-					glEnd();
-
-					// add triangle 2
-					// - add vertices and per-vertex normals
-					glBegin(GL_POLYGON);
-					glNormal3d(normal2[0], normal2[1], normal2[2]);
-					glVertex3d(point2[0], point2[1], point2[2]);
-					glNormal3d(normal4[0], normal4[1], normal4[2]);
-					glVertex3d(point4[0], point4[1], point4[2]);
-					glNormal3d(normal3[0], normal3[1], normal3[2]);
-					glVertex3d(point3[0], point3[1], point3[2]);
-					glEnd();
-				}
-			}
+			// triangles with per vertex normals, from the vertex buffers
+			_buffers.render(*_geometry);
 
 			// finalize display list
 			m_displayList.end(true);
@@ -5,6 +5,7 @@
 
 #include <Eigen/Core>
 
+#include "PrimitiveGeometry.h"
 #include "chai3d.h"
 
 namespace chai3d {
@@ -55,8 +56,17 @@ protected:
 	// render: from parent class
 	virtual void render(chai3d::cRenderOptions& a_options);
 
+	// boundary box of the capsule: from parent class
+	virtual void updateBoundaryBox();
+
 	// internal functions but public
 public:
+	// re-uploads the vertex buffers at the next render: from parent class
+	virtual void markForUpdate(const bool a_affectChildren = true);
+
+	// triangles of the capsule in its local frame
+	const cPrimitiveGeometry& getGeometry() const { return *_geometry; }
+
 	// radius of cross section at a point along line segment.
 	// @param s Length along line segment from 0 to length.
 	double radius(double s) const;
@@ -87,6 +97,13 @@ public:
 
 	// number of plane cross sections along the length of the capsule
 	uint _num_longitudinal_slices;
+
+protected:
+	// triangles of the capsule, built once in the ctor
+	cPrimitiveGeometryPtr _geometry;
+
+	// vertex buffers of the triangles
+	cPrimitiveBuffers _buffers;
 };
 
 // function to create cMultiMesh for capsule shape
@@ -0,0 +1,234 @@
+// LevelOfDetail.cpp
+
+#include "LevelOfDetail.h"
+
+#include <math.h>
+
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace std;
+
+namespace chai3d {
+
+namespace {
+// the cell indices are packed on 21 bits each in the cluster keys
+const uint64_t CELL_INDEX_MASK = (1 << 21) - 1;
+
+uint64_t cellIndex(double a_coordinate, double a_origin, double a_cellSize) {
+	const double index = floor((a_coordinate - a_origin) / a_cellSize);
+	if (index <= 0) {
+		return 0;
+	}
+	return min((uint64_t)index, CELL_INDEX_MASK);
+}
+
+// vertices of a cell of the clustering grid
+struct Cluster {
+	cVector3d position_sum;
+	float color_sum[4];
+	unsigned int num_vertices;
+};
+}  // namespace
+
+// ctor
+cLevelOfDetail::cLevelOfDetail() : m_level(0) {}
+
+// dtor
+cLevelOfDetail::~cLevelOfDetail() {
+	// the levels are children, deleted with this object
+}
+
+void cLevelOfDetail::addLevel(cGenericObject* a_level, double a_error) {
+	addChild(a_level);
+	m_levels.push_back(a_level);
+	m_errors.push_back(a_error);
+	a_level->setEnabled(m_levels.size() - 1 == m_level, false);
+}
+
+void cLevelOfDetail::setLevel(unsigned int a_level) {
+	if (a_level >= m_levels.size()) {
+		return;
+	}
+	// all the levels are updated, even if the level does not change, since a
+	// recursive enable of a parent may have shown several of them
+	m_level = a_level;
+	for (unsigned int i = 0; i < m_levels.size(); i++) {
+		m_levels[i]->setEnabled(i == m_level, false);
+	}
+}
+
+void cLevelOfDetail::setEnabled(bool a_enabled, const bool a_affectChildren) {
+	cGenericObject::setEnabled(a_enabled, a_affectChildren);
+	// a recursive enable shows all the levels, only the current one stays
+	for (unsigned int i = 0; i < m_levels.size(); i++) {
+		if (i != m_level) {
+			m_levels[i]->setEnabled(false, false);
+		}
+	}
+}
+
+unsigned int cLevelOfDetail::selectLevel(double a_pixelsPerMeter,
+										 double a_maxPixelError,
+										 double a_hysteresis,
+										 unsigned int a_slot) {
+	if (a_slot >= m_selectedLevels.size()) {
+		m_selectedLevels.resize(a_slot + 1, 0);
+	}
+	unsigned int level = min(m_selectedLevels[a_slot],
+							 (unsigned int)m_levels.size() - 1);
+	// finer levels while the error is visible
+	while (level > 0 && m_errors[level] * a_pixelsPerMeter > a_maxPixelError) {
+		level--;
+	}
+	// coarser levels only well inside the threshold
+	const double coarser_error = (1.0 - a_hysteresis) * a_maxPixelError;
+	while (level + 1 < m_levels.size() &&
+		   m_errors[level + 1] * a_pixelsPerMeter <= coarser_error) {
+		level++;
+	}
+	m_selectedLevels[a_slot] = level;
+	setLevel(level);
+	return level;
+}
+
+unsigned int cDecimateMesh(cMesh* a_output, cMesh* a_input,
+						   const cVector3d& a_gridOrigin, double a_cellSize) {
+	const unsigned int num_vertices = a_input->getNumVertices();
+	const bool use_colors = a_input->getUseVertexColors();
+
+	// cluster of each vertex
+	unordered_map<uint64_t, unsigned int> cluster_indices;
+	cluster_indices.reserve(num_vertices / 4 + 1);
+	vector<Cluster> clusters;
+	vector<unsigned int> vertex_clusters(num_vertices);
+	for (unsigned int i = 0; i < num_vertices; i++) {
+		const cVector3d pos = a_input->m_vertices->getLocalPos(i);
+		const uint64_t key =
+			(cellIndex(pos.x(), a_gridOrigin.x(), a_cellSize) << 42) |
+			(cellIndex(pos.y(), a_gridOrigin.y(), a_cellSize) << 21) |
+			cellIndex(pos.z(), a_gridOrigin.z(), a_cellSize);
+		auto inserted = cluster_indices.emplace(key, clusters.size());
+		if (inserted.second) {
+			clusters.push_back(Cluster{cVector3d(0, 0, 0), {0, 0, 0, 0}, 0});
+		}
+		Cluster& cluster = clusters[inserted.first->second];
+		cluster.position_sum += pos;
+		if (use_colors) {
+			const cColorf color = a_input->m_vertices->getColor(i);
+			for (int c = 0; c < 4; c++) {
+				cluster.color_sum[c] += color[c];
+			}
+		}
+		cluster.num_vertices++;
+		vertex_clusters[i] = inserted.first->second;
+	}
+
+	// one vertex per cluster, at the mean position
+	for (const auto& cluster : clusters) {
+		const double weight = 1.0 / cluster.num_vertices;
+		cColorf color;
+		if (use_colors) {
+			color.set(cluster.color_sum[0] * weight,
+					  cluster.color_sum[1] * weight,
+					  cluster.color_sum[2] * weight,
+					  cluster.color_sum[3] * weight);
+		}
+		a_output->newVertex(weight * cluster.position_sum, cVector3d(0, 0, 1),
+							cVector3d(0, 0, 0), color);
+	}
+
+	// triangles between 3 different clusters, without duplicates
+	unordered_set<uint64_t> triangle_keys;
+	const bool check_duplicates = clusters.size() <= CELL_INDEX_MASK;
+	const unsigned int num_triangles = a_input->m_triangles->getNumElements();
+	for (unsigned int i = 0; i < num_triangles; i++) {
+		if (!a_input->m_triangles->getAllocated(i)) {
+			continue;
+		}
+		const uint64_t c0 =
+			vertex_clusters[a_input->m_triangles->getVertexIndex0(i)];
+		const uint64_t c1 =
+			vertex_clusters[a_input->m_triangles->getVertexIndex1(i)];
+		const uint64_t c2 =
+			vertex_clusters[a_input->m_triangles->getVertexIndex2(i)];
+		if (c0 == c1 || c1 == c2 || c2 == c0) {
+			continue;
+		}
+		if (check_duplicates) {
+			const uint64_t c_min = min(c0, min(c1, c2));
+			const uint64_t c_max = max(c0, max(c1, c2));
+			const uint64_t c_mid = c0 + c1 + c2 - c_min - c_max;
+			if (!triangle_keys.insert((c_min << 42) | (c_mid << 21) | c_max)
+					 .second) {
+				continue;
+			}
+		}
+		a_output->newTriangle(c0, c1, c2);
+	}
+
+	a_output->computeAllNormals();
+	a_output->m_material = a_input->m_material;
+	a_output->setUseMaterial(a_input->getUseMaterial(), false);
+	a_output->setUseVertexColors(use_colors, false);
+	a_output->setUseTransparency(a_input->getUseTransparency(), false);
+	return a_output->getNumTriangles();
+}
+
+cLevelOfDetail* cCreateLevelsOfDetail(cMultiMesh* a_mesh,
+									  unsigned int a_maxLevels,
+									  unsigned int a_minTriangles) {
+	if (a_mesh->getNumTriangles() < a_minTriangles) {
+		return NULL;
+	}
+	// the texture coordinates are not preserved by the decimation
+	for (unsigned int i = 0; i < a_mesh->getNumMeshes(); i++) {
+		if (a_mesh->getMesh(i)->getUseTexture()) {
+			return NULL;
+		}
+	}
+	a_mesh->computeBoundaryBox(true);
+	const cVector3d box_min = a_mesh->getBoundaryMin();
+	const cVector3d box_size = a_mesh->getBoundaryMax() - box_min;
+	const double extent = max(box_size.x(), max(box_size.y(), box_size.z()));
+	if (!(extent > 0)) {
+		return NULL;
+	}
+
+	cLevelOfDetail* lod = new cLevelOfDetail();
+	lod->addLevel(a_mesh, 0.0);
+	unsigned int num_triangles = a_mesh->getNumTriangles();
+	unsigned int resolution = C_LOD_BASE_RESOLUTION;
+	for (unsigned int level = 0; level < a_maxLevels && resolution > 1;
+		 level++, resolution /= 2) {
+		const double cell_size = extent / resolution;
+		cMultiMesh* level_mesh = new cMultiMesh();
+		for (unsigned int i = 0; i < a_mesh->getNumMeshes(); i++) {
+			cMesh* mesh = new cMesh();
+			if (cDecimateMesh(mesh, a_mesh->getMesh(i), box_min, cell_size) >
+				0) {
+				level_mesh->addMesh(mesh);
+			} else {
+				delete mesh;
+			}
+		}
+		const unsigned int level_triangles = level_mesh->getNumTriangles();
+		// a level that does not halve the triangles is not worth switching to
+		if (level_triangles == 0 || 2 * level_triangles > num_triangles) {
+			delete level_mesh;
+			continue;
+		}
+		level_mesh->m_name = a_mesh->m_name;
+		// the vertices move by up to one cell
+		lod->addLevel(level_mesh, cell_size);
+		num_triangles = level_triangles;
+	}
+	if (lod->getNumLevels() == 1) {
+		lod->removeChild(a_mesh);
+		delete lod;
+		return NULL;
+	}
+	return lod;
+}
+
+}  // namespace chai3d
@@ -0,0 +1,127 @@
+// LevelOfDetail.h: Chai group switching between decimated versions of a mesh
+
+#ifndef CLEVELOFDETAIL_H
+#define CLEVELOFDETAIL_H
+
+#include <vector>
+
+#include "chai3d.h"
+
+namespace chai3d {
+
+// default parameters of the levels of detail generated for the loaded meshes
+// meshes with fewer triangles are not decimated
+const unsigned int C_LOD_MIN_TRIANGLES = 2000;
+// maximum number of decimated levels
+const unsigned int C_LOD_MAX_LEVELS = 3;
+// number of cells of the clustering grid along the largest dimension of the
+// mesh for the first decimated level, halved at each level
+const unsigned int C_LOD_BASE_RESOLUTION = 128;
+
+// local coordinate system: same as the levels, which are children of this
+// object with an identity local pose
+
+class cLevelOfDetail : public chai3d::cGenericObject {
+public:
+	// ctor
+	cLevelOfDetail();
+
+	// dtor
+	virtual ~cLevelOfDetail();
+
+	/**
+	 * @brief Adds a level as a child of this object. The levels are added
+	 * from the finest (level 0) to the coarsest.
+	 * @param a_level Mesh of the level.
+	 * @param a_error Geometric error of the level in meters (0 for the
+	 * original mesh).
+	 */
+	void addLevel(cGenericObject* a_level, double a_error);
+
+	// number of levels
+	unsigned int getNumLevels() const { return m_levels.size(); }
+
+	// object of a level
+	cGenericObject* getLevelObject(unsigned int a_level) const {
+		return m_levels[a_level];
+	}
+
+	// geometric error of a level in meters
+	double getLevelError(unsigned int a_level) const {
+		return m_errors[a_level];
+	}
+
+	// shows a single level and hides the others
+	void setLevel(unsigned int a_level);
+
+	// enables or disables this object. When applied to the children, only the
+	// current level is enabled: from parent class
+	virtual void setEnabled(bool a_enabled,
+							const bool a_affectChildren = false);
+
+	// level currently shown
+	unsigned int getLevel() const { return m_level; }
+
+	/**
+	 * @brief Shows the coarsest level whose error projects to at most
+	 * a_maxPixelError pixels, with hysteresis: the level selected for the
+	 * same slot at the previous call is only replaced by a coarser level if
+	 * its error projects to less than (1 - a_hysteresis) * a_maxPixelError
+	 * pixels, so that the level does not flicker when the projected size
+	 * oscillates around a switching size.
+	 * @param a_pixelsPerMeter Projected size of one meter at the distance of
+	 * the object, in pixels.
+	 * @param a_maxPixelError Maximum projected error in pixels.
+	 * @param a_hysteresis Relative width of the hysteresis band, in [0, 1).
+	 * @param a_slot Slot storing the previous selection (one per camera).
+	 * @return The selected level.
+	 */
+	unsigned int selectLevel(double a_pixelsPerMeter, double a_maxPixelError,
+							 double a_hysteresis, unsigned int a_slot);
+
+protected:
+	// levels, from the finest to the coarsest
+	std::vector<cGenericObject*> m_levels;
+
+	// geometric error of each level in meters
+	std::vector<double> m_errors;
+
+	// level currently shown
+	unsigned int m_level;
+
+	// level selected at the last call to selectLevel for each slot
+	std::vector<unsigned int> m_selectedLevels;
+};
+
+/**
+ * @brief Decimates a mesh by vertex clustering: the vertices are merged per
+ * cell of a regular grid, at the mean position of the vertices of the cell,
+ * and the triangles that become degenerate or duplicated are removed. The
+ * normals are recomputed and the material and rendering flags are shared
+ * with the input mesh. Texture coordinates are not kept.
+ * @param a_output Mesh to fill, expected empty.
+ * @param a_input Mesh to decimate.
+ * @param a_gridOrigin Corner of the clustering grid.
+ * @param a_cellSize Size of the cells of the grid.
+ * @return The number of triangles of the decimated mesh.
+ */
+unsigned int cDecimateMesh(cMesh* a_output, cMesh* a_input,
+						   const cVector3d& a_gridOrigin, double a_cellSize);
+
+/**
+ * @brief Creates the levels of detail of a multi mesh. The multi mesh becomes
+ * the level 0, and decimated versions with increasing cell sizes are added as
+ * long as each one has at most half the triangles of the previous one.
+ * @param a_mesh Mesh to decimate, becomes a child of the returned object.
+ * @param a_maxLevels Maximum number of decimated levels.
+ * @param a_minTriangles Minimum number of triangles of the mesh to decimate.
+ * @return The levels of detail (showing level 0), or NULL if the mesh is too
+ * small or textured, in which case a_mesh is left untouched.
+ */
+cLevelOfDetail* cCreateLevelsOfDetail(
+	cMultiMesh* a_mesh, unsigned int a_maxLevels = C_LOD_MAX_LEVELS,
+	unsigned int a_minTriangles = C_LOD_MIN_TRIANGLES);
+
+}  // namespace chai3d
+
+#endif	// CLEVELOFDETAIL_H
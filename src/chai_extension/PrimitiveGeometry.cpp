@@ -0,0 +1,261 @@
+// PrimitiveGeometry.cpp
+
+#include "PrimitiveGeometry.h"
+
+#include <math.h>
+
+#include <Eigen/Geometry>
+#include <algorithm>
+
+using namespace std;
+
+using namespace Eigen;
+
+namespace chai3d {
+
+unsigned int cPrimitiveGeometry::newVertex(const Vector3d& a_position,
+										   const Vector3d& a_normal) {
+	const unsigned int index = getNumVertices();
+	for (int i = 0; i < 3; i++) {
+		m_vertexData.push_back(a_position[i]);
+	}
+	for (int i = 0; i < 3; i++) {
+		m_vertexData.push_back(a_normal[i]);
+	}
+	return index;
+}
+
+void cPrimitiveGeometry::newTriangle(unsigned int a_vertex0,
+									 unsigned int a_vertex1,
+									 unsigned int a_vertex2) {
+	m_indices.push_back(a_vertex0);
+	m_indices.push_back(a_vertex1);
+	m_indices.push_back(a_vertex2);
+}
+
+Vector3d cPrimitiveGeometry::getPosition(unsigned int a_vertex) const {
+	const float* data = &m_vertexData[a_vertex * s_vertexStride];
+	return Vector3d(data[0], data[1], data[2]);
+}
+
+Vector3d cPrimitiveGeometry::getNormal(unsigned int a_vertex) const {
+	const float* data = &m_vertexData[a_vertex * s_vertexStride + 3];
+	return Vector3d(data[0], data[1], data[2]);
+}
+
+// ctor
+cPrimitiveBuffers::cPrimitiveBuffers()
+	: m_vertexBuffer(0), m_indexBuffer(0), m_uploaded(false) {}
+
+// dtor
+cPrimitiveBuffers::~cPrimitiveBuffers() {
+#ifdef C_USE_OPENGL
+	if (m_vertexBuffer != 0) {
+		glDeleteBuffers(1, &m_vertexBuffer);
+	}
+	if (m_indexBuffer != 0) {
+		glDeleteBuffers(1, &m_indexBuffer);
+	}
+#endif
+}
+
+void cPrimitiveBuffers::render(const cPrimitiveGeometry& a_geometry) {
+#ifdef C_USE_OPENGL
+	if (a_geometry.m_indices.empty()) {
+		return;
+	}
+
+	// the buffers are created once, and filled again when marked for update
+	if (m_vertexBuffer == 0) {
+		glGenBuffers(1, &m_vertexBuffer);
+	}
+	if (m_indexBuffer == 0) {
+		glGenBuffers(1, &m_indexBuffer);
+	}
+	if (!m_uploaded) {
+		glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+		glBufferData(GL_ARRAY_BUFFER,
+					 a_geometry.m_vertexData.size() * sizeof(float),
+					 a_geometry.m_vertexData.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+					 a_geometry.m_indices.size() * sizeof(unsigned int),
+					 a_geometry.m_indices.data(), GL_STATIC_DRAW);
+		m_uploaded = true;
+	}
+
+	const GLsizei stride =
+		cPrimitiveGeometry::s_vertexStride * sizeof(GLfloat);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(3, GL_FLOAT, stride, (const GLvoid*)0);
+	glEnableClientState(GL_NORMAL_ARRAY);
+	glNormalPointer(GL_FLOAT, stride, (const GLvoid*)(3 * sizeof(GLfloat)));
+
+	glDrawElements(GL_TRIANGLES, a_geometry.m_indices.size(), GL_UNSIGNED_INT,
+				   (const GLvoid*)0);
+
+	glDisableClientState(GL_NORMAL_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+#endif
+}
+
+void cBuildCapsuleGeometry(cPrimitiveGeometry& a_geometry, double a_radius,
+						   double a_length,
+						   unsigned int a_numLongitudinalSlices,
+						   unsigned int a_numCircumferentialSlices) {
+	// compute spacing parameters
+	const double ds_longitudinal = a_length / (a_numLongitudinalSlices - 1);
+	double ds_longitudinal_cap = ds_longitudinal / 3.0;
+	const double ds_angle = 2.0 * M_PI / a_numCircumferentialSlices;
+
+	const unsigned int nv_endcap_offset =
+		max((unsigned int)10,
+			(unsigned int)(a_radius / ds_longitudinal_cap) + 1);
+	ds_longitudinal_cap = a_radius / (nv_endcap_offset - 1);
+	const unsigned int nv_long_wendcaps =
+		a_numLongitudinalSlices + nv_endcap_offset * 2;
+
+	// position of the cross sections along the capsule. The last plane of each
+	// endcap coincides with the first or last plane of the cylinder, it is
+	// only kept once
+	vector<double> sections;
+	for (unsigned int i = 0; i < nv_long_wendcaps; i++) {
+		double s;
+		if (i < nv_endcap_offset) {
+			s = i * ds_longitudinal_cap - a_radius;
+		} else if (i > nv_endcap_offset + a_numLongitudinalSlices - 1) {
+			s = (i - nv_endcap_offset - a_numLongitudinalSlices) *
+					ds_longitudinal_cap +
+				a_length;
+		} else {
+			s = (i - nv_endcap_offset) * ds_longitudinal;
+		}
+		s = min(s, a_length + a_radius);
+		if (sections.empty() || s > sections.back() + 1e-12) {
+			sections.push_back(s);
+		}
+	}
+
+	// the angles are the same for all the rings
+	vector<double> cos_eta(a_numCircumferentialSlices);
+	vector<double> sin_eta(a_numCircumferentialSlices);
+	for (unsigned int j = 0; j < a_numCircumferentialSlices; j++) {
+		cos_eta[j] = cos(j * ds_angle);
+		sin_eta[j] = sin(j * ds_angle);
+	}
+
+	// vertices: first end, rings, last end
+	a_geometry.newVertex(Vector3d(-a_radius, 0, 0), Vector3d(-1, 0, 0));
+	for (unsigned int i = 1; i + 1 < sections.size(); i++) {
+		const double s = sections[i];
+		// center of the sphere of the endcap, or of the cross section
+		double center = s;
+		if (s < 0.0) {
+			center = 0.0;
+		} else if (s > a_length) {
+			center = a_length;
+		}
+		const double t =
+			sqrt(max(a_radius * a_radius - (s - center) * (s - center), 0.0));
+		for (unsigned int j = 0; j < a_numCircumferentialSlices; j++) {
+			const Vector3d point(s, t * cos_eta[j], t * sin_eta[j]);
+			a_geometry.newVertex(
+				point, (point - Vector3d(center, 0, 0)).normalized());
+		}
+	}
+	const unsigned int last_end = a_geometry.newVertex(
+		Vector3d(a_length + a_radius, 0, 0), Vector3d(1, 0, 0));
+
+	// triangles
+	if (sections.size() < 3) {
+		return;
+	}
+	const unsigned int num_rings = sections.size() - 2;
+	for (unsigned int j = 0; j < a_numCircumferentialSlices; j++) {
+		const unsigned int j1 = (j + 1) % a_numCircumferentialSlices;
+		a_geometry.newTriangle(0, 1 + j1, 1 + j);
+	}
+	for (unsigned int i = 0; i + 1 < num_rings; i++) {
+		const unsigned int ring = 1 + i * a_numCircumferentialSlices;
+		const unsigned int next_ring = ring + a_numCircumferentialSlices;
+		for (unsigned int j = 0; j < a_numCircumferentialSlices; j++) {
+			const unsigned int j1 = (j + 1) % a_numCircumferentialSlices;
+			a_geometry.newTriangle(ring + j, ring + j1, next_ring + j);
+			a_geometry.newTriangle(ring + j1, next_ring + j1, next_ring + j);
+		}
+	}
+	const unsigned int last_ring =
+		1 + (num_rings - 1) * a_numCircumferentialSlices;
+	for (unsigned int j = 0; j < a_numCircumferentialSlices; j++) {
+		const unsigned int j1 = (j + 1) % a_numCircumferentialSlices;
+		a_geometry.newTriangle(last_ring + j, last_ring + j1, last_end);
+	}
+}
+
+void cBuildPyramidGeometry(cPrimitiveGeometry& a_geometry,
+						   const vector<Vector3d>& a_baseVertices,
+						   const Vector3d& a_apex,
+						   bool a_useBaseCenterVertex) {
+	const unsigned int num_sides = a_baseVertices.size();
+
+	// base, facing down, wound clockwise around z to face its normal
+	const Vector3d base_normal(0, 0, -1);
+	const unsigned int base_start = a_geometry.getNumVertices();
+	for (const auto& vertex : a_baseVertices) {
+		a_geometry.newVertex(vertex, base_normal);
+	}
+	if (a_useBaseCenterVertex) {
+		const unsigned int center =
+			a_geometry.newVertex(Vector3d::Zero(), base_normal);
+		for (unsigned int i = 0; i < num_sides; i++) {
+			a_geometry.newTriangle(center, base_start + (i + 1) % num_sides,
+								   base_start + i);
+		}
+	} else {
+		for (unsigned int i = 1; i + 1 < num_sides; i++) {
+			a_geometry.newTriangle(base_start, base_start + i + 1,
+								   base_start + i);
+		}
+	}
+
+	// sides, each with its own vertices for flat shading
+	for (unsigned int i = 0; i < num_sides; i++) {
+		const Vector3d& vertex1 = a_baseVertices[i];
+		const Vector3d& vertex2 = a_baseVertices[(i + 1) % num_sides];
+		const Vector3d normal =
+			(vertex1 - a_apex).cross(vertex2 - a_apex).normalized();
+		const unsigned int apex = a_geometry.newVertex(a_apex, normal);
+		const unsigned int index1 = a_geometry.newVertex(vertex1, normal);
+		const unsigned int index2 = a_geometry.newVertex(vertex2, normal);
+		a_geometry.newTriangle(apex, index1, index2);
+	}
+}
+
+void cAddGeometryToMesh(cMesh* a_mesh, const cPrimitiveGeometry& a_geometry,
+						const vector<cColorf>& a_colors) {
+	const unsigned int num_vertices = a_geometry.getNumVertices();
+	if (num_vertices == 0) {
+		return;
+	}
+	unsigned int first_vertex = 0;
+	for (unsigned int i = 0; i < num_vertices; i++) {
+		const unsigned int index =
+			a_mesh->newVertex(cVector3d(a_geometry.getPosition(i)),
+							  cVector3d(a_geometry.getNormal(i)),
+							  cVector3d(0, 0, 0), a_colors[i]);
+		if (i == 0) {
+			first_vertex = index;
+		}
+	}
+	for (unsigned int i = 0; i + 2 < a_geometry.m_indices.size(); i += 3) {
+		a_mesh->newTriangle(first_vertex + a_geometry.m_indices[i],
+							first_vertex + a_geometry.m_indices[i + 1],
+							first_vertex + a_geometry.m_indices[i + 2]);
+	}
+}
+
+}  // namespace chai3d
@@ -0,0 +1,127 @@
+// PrimitiveGeometry.h: indexed triangle geometry of the capsule and pyramid
+// primitives, and its OpenGL buffers
+
+#ifndef CPRIMITIVEGEOMETRY_H
+#define CPRIMITIVEGEOMETRY_H
+
+#include <Eigen/Core>
+#include <memory>
+#include <vector>
+
+#include "chai3d.h"
+
+namespace chai3d {
+
+// triangles of a primitive in its local frame. The vertices are stored
+// interleaved as 6 floats (position then normal) so that they can be uploaded
+// as a single vertex buffer. The geometry is built once from the parameters of
+// the primitive and never modified, so it can be shared between objects and
+// rendering contexts
+struct cPrimitiveGeometry {
+	// number of floats per vertex
+	static const unsigned int s_vertexStride = 6;
+
+	// interleaved positions and normals
+	std::vector<float> m_vertexData;
+
+	// vertex indices, 3 per triangle
+	std::vector<unsigned int> m_indices;
+
+	// adds a vertex and returns its index
+	unsigned int newVertex(const Eigen::Vector3d& a_position,
+						   const Eigen::Vector3d& a_normal);
+
+	// adds a triangle
+	void newTriangle(unsigned int a_vertex0, unsigned int a_vertex1,
+					 unsigned int a_vertex2);
+
+	// number of vertices
+	unsigned int getNumVertices() const {
+		return m_vertexData.size() / s_vertexStride;
+	}
+
+	// number of triangles
+	unsigned int getNumTriangles() const { return m_indices.size() / 3; }
+
+	// position of a vertex
+	Eigen::Vector3d getPosition(unsigned int a_vertex) const;
+
+	// normal of a vertex
+	Eigen::Vector3d getNormal(unsigned int a_vertex) const;
+};
+
+typedef std::shared_ptr<const cPrimitiveGeometry> cPrimitiveGeometryPtr;
+
+// vertex and index buffers of a primitive geometry. The buffers are created and
+// uploaded at the first render, in the OpenGL context of that render, and
+// drawn with a single glDrawElements call afterwards. As in cVertexArray, the
+// buffer ids are generated once and reused by the later uploads
+class cPrimitiveBuffers {
+public:
+	// ctor
+	cPrimitiveBuffers();
+
+	// dtor, deletes the buffers (the context of the rendering must be current)
+	~cPrimitiveBuffers();
+
+	cPrimitiveBuffers(const cPrimitiveBuffers&) = delete;
+	cPrimitiveBuffers& operator=(const cPrimitiveBuffers&) = delete;
+
+	// draws the geometry with the current material
+	void render(const cPrimitiveGeometry& a_geometry);
+
+	// uploads the geometry again at the next render, into the same buffers
+	void markForUpdate() { m_uploaded = false; }
+
+protected:
+	unsigned int m_vertexBuffer;
+	unsigned int m_indexBuffer;
+	bool m_uploaded;
+};
+
+/**
+ * @brief Builds the geometry of a capsule. The cross sections are rings of
+ * vertices shared by the triangles on both sides of the ring, and the ends of
+ * the capsule are single vertices: vertex 0 is the end at x = -a_radius, then
+ * come the rings from the smallest to the largest x, vertex j of a ring being
+ * at the angle 2 * pi * j / a_numCircumferentialSlices around x from the y
+ * axis, and the last vertex is the end at x = a_length + a_radius.
+ * @param a_geometry Geometry to fill, expected empty.
+ * @param a_radius Radius of the capsule.
+ * @param a_length Length of the line segment of the capsule, along x.
+ * @param a_numLongitudinalSlices Number of cross sections along the line
+ * segment.
+ * @param a_numCircumferentialSlices Number of vertices per cross section.
+ */
+void cBuildCapsuleGeometry(cPrimitiveGeometry& a_geometry, double a_radius,
+						   double a_length,
+						   unsigned int a_numLongitudinalSlices,
+						   unsigned int a_numCircumferentialSlices);
+
+/**
+ * @brief Builds the geometry of a pyramid with flat shaded faces.
+ * @param a_geometry Geometry to fill, expected empty.
+ * @param a_baseVertices Vertices of the base polygon, counterclockwise around
+ * z.
+ * @param a_apex Apex of the pyramid.
+ * @param a_useBaseCenterVertex Whether the base is a fan around its center or
+ * around its first vertex.
+ */
+void cBuildPyramidGeometry(cPrimitiveGeometry& a_geometry,
+						   const std::vector<Eigen::Vector3d>& a_baseVertices,
+						   const Eigen::Vector3d& a_apex,
+						   bool a_useBaseCenterVertex);
+
+/**
+ * @brief Appends the vertices and triangles of a primitive geometry to a mesh,
+ * keeping the vertices shared by several triangles shared in the mesh.
+ * @param a_mesh Mesh to add the geometry to.
+ * @param a_geometry Geometry to add.
+ * @param a_colors Color of each vertex of the geometry.
+ */
+void cAddGeometryToMesh(cMesh* a_mesh, const cPrimitiveGeometry& a_geometry,
+						const std::vector<cColorf>& a_colors);
+
+}  // namespace chai3d
+
+#endif	// CPRIMITIVEGEOMETRY_H
@@ -38,6 +38,13 @@ cPyramid::cPyramid(uint num_sides_base, double length_base_side, double height,
 	_apex << 0, 0, _height;
 
 	generateLocalVertexList();
+
+	// triangles, rendered from the same vertex buffers at every frame
+	std::shared_ptr<cPrimitiveGeometry> geometry =
+		std::make_shared<cPrimitiveGeometry>();
+	cBuildPyramidGeometry(*geometry, _base_vertices, _apex,
+						  _f_use_base_center_vertex);
+	_geometry = geometry;
 }
 
 // dtor
@@ -45,6 +52,19 @@ cPyramid::~cPyramid() {
 	// nothing to do
 }
 
+// boundary box of the base vertices and the apex
+void cPyramid::updateBoundaryBox() {
+	Vector3d box_min = _apex;
+	Vector3d box_max = _apex;
+	for (const auto& vertex : _base_vertices) {
+		box_min = box_min.cwiseMin(vertex);
+		box_max = box_max.cwiseMax(vertex);
+	}
+	m_boundaryBoxMin.set(box_min.x(), box_min.y(), box_min.z());
+	m_boundaryBoxMax.set(box_max.x(), box_max.y(), box_max.z());
+	m_boundaryBoxEmpty = false;
+}
+
 void cPyramid::generateLocalVertexList() {
 	Vector3d vertex0(_circum_radius, 0, 0);
 	for (uint i = 0; i < _num_sides_base; i++) {
@@ -53,10 +73,15 @@ void cPyramid::generateLocalVertexList() {
 	}
 }
 
+// re-upload the vertex buffers, e.g. for a new OpenGL context
+void cPyramid::markForUpdate(const bool a_affectChildren) {
+	cGenericObject::markForUpdate(a_affectChildren);
+	_buffers.markForUpdate();
+}
+
 // render
 void cPyramid::render(cRenderOptions& a_options) {
 #ifdef C_USE_OPENGL
-
 	/////////////////////////////////////////////////////////////////////////
 	// ENABLE SHADER
 	/////////////////////////////////////////////////////////////////////////
@@ -78,76 +103,8 @@ void cPyramid::render(cRenderOptions& a_options) {
 			// create display list if requested
 			m_displayList.begin(m_useDisplayList);
 
-			// base
-			if (_f_use_base_center_vertex) {
-				Vector3d normal(0, 0, -1);
-				for (uint i = 0; i < _num_sides_base - 1; i++) {
-					glBegin(GL_POLYGON);
-					glNormal3d(normal[0], normal[1], normal[2]);
-					glVertex3d(0, 0, 0);
-					glVertex3d(_base_vertices[i][0], _base_vertices[i][1],
-							   _base_vertices[i][2]);
-					glVertex3d(_base_vertices[i + 1][0],
-							   _base_vertices[i + 1][1],
-							   _base_vertices[i + 1][2]);
-					glEnd();
-				}
-				// add last triangle
-				glBegin(GL_POLYGON);
-				glNormal3d(normal[0], normal[1], normal[2]);
-				glVertex3d(0, 0, 0);
-				glVertex3d(_base_vertices[_num_sides_base - 1][0],
-						   _base_vertices[_num_sides_base - 1][1],
-						   _base_vertices[_num_sides_base - 1][2]);
-				glVertex3d(_base_vertices[0][0], _base_vertices[0][1],
-						   _base_vertices[0][2]);
-				glEnd();
-			} else {
-				Vector3d normal(0, 0, -1);
-				Vector3d point0 = _base_vertices[0];
-				for (uint i = 1; i < _num_sides_base - 1; i++) {
-					glBegin(GL_POLYGON);
-					glNormal3d(normal[0], normal[1], normal[2]);
-					glVertex3d(point0[0], point0[1], point0[2]);
-					glVertex3d(_base_vertices[i][0], _base_vertices[i][1],
-							   _base_vertices[i][2]);
-					glVertex3d(_base_vertices[i + 1][0],
-							   _base_vertices[i + 1][1],
-							   _base_vertices[i + 1][2]);
-					glEnd();
-				}
-			}
-
-			// sides
-			for (uint i = 0; i < _num_sides_base - 1; i++) {
-				Vector3d normal =
-					AngleAxisd(_included_angle * i, Vector3d::UnitZ()) *
-					_normal0;
-				glBegin(GL_POLYGON);
-				glNormal3d(normal[0], normal[1], normal[2]);
-				glVertex3d(_apex[0], _apex[1], _apex[2]);
-				glVertex3d(_base_vertices[i][0], _base_vertices[i][1],
-						   _base_vertices[i][2]);
-				glVertex3d(_base_vertices[i + 1][0], _base_vertices[i + 1][1],
-						   _base_vertices[i + 1][2]);
-				glEnd();
-			}
-			// last triangle
-			{
-				Vector3d normal =
-					AngleAxisd(_included_angle * (_num_sides_base - 1),
-							   Vector3d::UnitZ()) *
-					_normal0;
-				glBegin(GL_POLYGON);
-				glNormal3d(normal[0], normal[1], normal[2]);
-				glVertex3d(_apex[0], _apex[1], _apex[2]);
-				glVertex3d(_base_vertices[_num_sides_base - 1][0],
-						   _base_vertices[_num_sides_base - 1][1],
-						   _base_vertices[_num_sides_base - 1][2]);
-				glVertex3d(_base_vertices[0][0], _base_vertices[0][1],
-						   _base_vertices[0][2]);
-				glEnd();
-			}
+			// flat shaded triangles, from the vertex buffers
+			_buffers.render(*_geometry);
 
 			// finalize display list
 			m_displayList.end(true);
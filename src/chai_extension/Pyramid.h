@@ -5,6 +5,7 @@
 #include <Eigen/Core>
 #include <vector>
 
+#include "PrimitiveGeometry.h"
 #include "chai3d.h"
 
 namespace chai3d {
@@ -36,6 +37,18 @@ protected:
 	// render: from parent class
 	virtual void render(chai3d::cRenderOptions& a_options);
 
+	// boundary box of the pyramid: from parent class
+	virtual void updateBoundaryBox();
+
+public:
+	// re-uploads the vertex buffers at the next render: from parent class
+	virtual void markForUpdate(const bool a_affectChildren = true);
+
+	// triangles of the pyramid in its local frame
+	const cPrimitiveGeometry& getGeometry() const { return *_geometry; }
+
+protected:
+
 	// private internal functions:
 	void generateLocalVertexList();
 
@@ -64,6 +77,13 @@ public:
 	Eigen::Vector3d _apex;
 
 	std::vector<Eigen::Vector3d> _base_vertices;
+
+protected:
+	// triangles of the pyramid, built once in the ctor
+	cPrimitiveGeometryPtr _geometry;
+
+	// vertex buffers of the triangles
+	cPrimitiveBuffers _buffers;
 };
 
 // function to create cMultiMesh for capsule shape
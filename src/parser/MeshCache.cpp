@@ -0,0 +1,187 @@
+#include "MeshCache.h"
+
+#include <algorithm>
+#include <mutex>
+#include <set>
+
+#include "chai_extension/LevelOfDetail.h"
+
+using namespace chai3d;
+
+namespace Parser {
+
+namespace {
+// serializes the obj and 3ds loaders of chai3d. They also load the textures of
+// the meshes (cTexture2d, cImage and the image file decoders), and they are
+// not known to be reentrant, so only one of them runs at a time. The stl
+// loader, which loads no textures, runs concurrently
+std::mutex textured_loader_mutex;
+
+// loads a stl, obj or 3ds file, returns false on failure
+bool loadMeshFile(cMultiMesh* mesh, const std::string& path) {
+	if (path.length() < 5) {
+		return false;
+	}
+	std::string extension = path.substr(path.length() - 4);
+	std::transform(extension.begin(), extension.end(), extension.begin(),
+				   [](unsigned char c) { return std::tolower(c); });
+	if (extension == ".stl") {
+		return cLoadFileSTL(mesh, path);
+	} else if (extension == ".obj") {
+		std::lock_guard<std::mutex> lock(textured_loader_mutex);
+		return cLoadFileOBJ(mesh, path);
+	} else if (extension == ".3ds") {
+		std::lock_guard<std::mutex> lock(textured_loader_mutex);
+		return cLoadFile3DS(mesh, path);
+	}
+	return false;
+}
+
+// loads, scales and builds the levels of detail of a mesh file. Returns a
+// cMultiMesh or a cLevelOfDetail, or NULL if the file could not be loaded
+cGenericObject* loadScaledMeshFile(const std::string& path,
+								   const cVector3d& scale) {
+	cMultiMesh* mesh = new cMultiMesh();
+	if (!loadMeshFile(mesh, path)) {
+		delete mesh;
+		return NULL;
+	}
+	mesh->scaleXYZ(scale.x(), scale.y(), scale.z());
+	// the levels of detail are computed once per mesh as well
+	cLevelOfDetail* lod = cCreateLevelsOfDetail(mesh);
+	return lod != NULL ? static_cast<cGenericObject*>(lod) : mesh;
+}
+
+// copy of a material of the loaded mesh for an instance. Meshes sharing a
+// material in the loaded mesh share its copy in the instance, so that
+// changing the color of the multi mesh still changes the color of its meshes
+cMaterialPtr instanceMaterial(
+	const cMaterialPtr& material,
+	std::map<cMaterial*, cMaterialPtr>& instance_materials) {
+	if (material == nullptr) {
+		return material;
+	}
+	auto it = instance_materials.find(material.get());
+	if (it != instance_materials.end()) {
+		return it->second;
+	}
+	cMaterialPtr copy = material->copy();
+	instance_materials[material.get()] = copy;
+	return copy;
+}
+
+// instance of a multi mesh sharing its mesh data and textures
+cMultiMesh* instanceMultiMesh(
+	cMultiMesh* loaded_mesh,
+	std::map<cMaterial*, cMaterialPtr>& instance_materials) {
+	cMultiMesh* instance = new cMultiMesh();
+	instance->m_name = loaded_mesh->m_name;
+	instance->m_material =
+		instanceMaterial(loaded_mesh->m_material, instance_materials);
+	for (unsigned int i = 0; i < loaded_mesh->getNumMeshes(); ++i) {
+		cMesh* loaded_submesh = loaded_mesh->getMesh(i);
+		cMesh* submesh = loaded_submesh->copy(false, false, false, false);
+		submesh->m_material =
+			instanceMaterial(loaded_submesh->m_material, instance_materials);
+		instance->addMesh(submesh);
+	}
+	return instance;
+}
+}  // namespace
+
+MeshCache::MeshCache(const unsigned int num_loading_threads)
+	: _num_loading_threads(num_loading_threads) {}
+
+MeshCache::~MeshCache() { clear(); }
+
+cGenericObject* MeshCache::instantiateMeshFile(const std::string& path,
+											   const cVector3d& scale,
+											   cMultiMesh*& base_mesh) {
+	base_mesh = NULL;
+	const MeshKey key(path, scale.x(), scale.y(), scale.z());
+	auto it = _meshes.find(key);
+	if (it == _meshes.end()) {
+		it = _meshes.emplace(key, loadScaledMeshFile(path, scale)).first;
+	}
+	if (it->second == NULL) {
+		return NULL;
+	}
+	_num_instances++;
+
+	std::map<cMaterial*, cMaterialPtr> instance_materials;
+	cLevelOfDetail* loaded_lod = dynamic_cast<cLevelOfDetail*>(it->second);
+	if (loaded_lod == NULL) {
+		base_mesh = instanceMultiMesh(static_cast<cMultiMesh*>(it->second),
+									  instance_materials);
+		return base_mesh;
+	}
+	// the decimated levels share the materials of the full resolution level
+	cLevelOfDetail* lod = new cLevelOfDetail();
+	for (unsigned int i = 0; i < loaded_lod->getNumLevels(); ++i) {
+		cMultiMesh* level = instanceMultiMesh(
+			static_cast<cMultiMesh*>(loaded_lod->getLevelObject(i)),
+			instance_materials);
+		lod->addLevel(level, loaded_lod->getLevelError(i));
+		if (i == 0) {
+			base_mesh = level;
+		}
+	}
+	return lod;
+}
+
+unsigned int MeshCache::preloadMeshFiles(
+	const std::vector<MeshFileRequest>& requests,
+	SaiGraphics::ThreadPool& pool) {
+	std::set<MeshKey> requested_keys;
+	std::vector<MeshKey> keys;
+	std::vector<const MeshFileRequest*> to_load;
+	for (const auto& request : requests) {
+		const MeshKey key(request.path, request.scale.x(), request.scale.y(),
+						  request.scale.z());
+		if (_meshes.count(key) == 0 && requested_keys.insert(key).second) {
+			keys.push_back(key);
+			to_load.push_back(&request);
+		}
+	}
+
+	std::vector<cGenericObject*> loaded(to_load.size(), NULL);
+	pool.parallelFor(to_load.size(), [&](size_t i) {
+		loaded[i] = loadScaledMeshFile(to_load[i]->path, to_load[i]->scale);
+	});
+	for (size_t i = 0; i < keys.size(); i++) {
+		_meshes.emplace(keys[i], loaded[i]);
+	}
+	return keys.size();
+}
+
+cMesh* MeshCache::instantiatePrimitive(const std::string& type,
+									  const std::vector<double>& parameters,
+									  const PrimitiveBuilder& build) {
+	const PrimitiveKey key(type, parameters);
+	auto it = _primitives.find(key);
+	if (it == _primitives.end()) {
+		cMesh* mesh = new cMesh();
+		build(mesh);
+		it = _primitives.emplace(key, mesh).first;
+	}
+	_num_primitive_instances++;
+
+	cMesh* instance = it->second->copy(false, false, false, false);
+	instance->m_material = it->second->m_material->copy();
+	return instance;
+}
+
+void MeshCache::clear() {
+	for (auto& mesh : _meshes) {
+		delete mesh.second;
+	}
+	_meshes.clear();
+	_num_instances = 0;
+	for (auto& primitive : _primitives) {
+		delete primitive.second;
+	}
+	_primitives.clear();
+	_num_primitive_instances = 0;
+}
+
+}  // namespace Parser
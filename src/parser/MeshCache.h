@@ -0,0 +1,153 @@
+/**
+ * \file MeshCache.h
+ *
+ * \brief Cache of the meshes loaded from files and of the primitive meshes
+ * created while parsing a world, so that the visuals using the same mesh file
+ * or the same primitive share its data.
+ */
+
+#ifndef SAI_GRAPHICS_MESH_CACHE_H
+#define SAI_GRAPHICS_MESH_CACHE_H
+
+#include <chai3d.h>
+
+#include <functional>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "utils/ThreadPool.h"
+
+namespace Parser {
+
+/// @brief a mesh file to load, at a given scale
+struct MeshFileRequest {
+	/// @brief resolved path of the mesh file
+	std::string path;
+	/// @brief scale applied to the mesh along each axis
+	chai3d::cVector3d scale;
+};
+
+/**
+ * @brief Loads each mesh file (at a given scale) once and creates the visuals
+ * as instances of it. The instances share the vertex and triangle arrays of
+ * the loaded mesh, and therefore its OpenGL buffers, which are uploaded once,
+ * as well as its textures and levels of detail. Each instance has its own
+ * local pose and its own copies of the materials, so that its color can be
+ * changed independently.
+ *
+ * Primitive shapes (boxes, spheres...) are cached the same way, keyed on
+ * their type and on all the parameters their mesh is generated from.
+ *
+ * The loaded meshes are kept outside of the world and deleted with the cache.
+ * The instances do not depend on the cache once created.
+ */
+class MeshCache {
+public:
+	/**
+	 * @brief Creates an empty cache
+	 *
+	 * @param num_loading_threads number of threads decoding the mesh files in
+	 * preloadMeshFiles, including the calling thread. 0 uses the number of
+	 * hardware threads, 1 decodes the files one after the other.
+	 */
+	explicit MeshCache(const unsigned int num_loading_threads = 0);
+	~MeshCache();
+
+	MeshCache(const MeshCache&) = delete;
+	MeshCache& operator=(const MeshCache&) = delete;
+
+	/**
+	 * @brief Creates an instance of a mesh file, loading the file the first
+	 * time it is requested with this scale.
+	 *
+	 * @param path resolved path of the mesh file (stl, obj or 3ds)
+	 * @param scale scale applied to the mesh along each axis
+	 * @param base_mesh set to the full resolution mesh of the instance
+	 * @return the instance, a chai3d::cMultiMesh or a chai3d::cLevelOfDetail
+	 * containing base_mesh, or NULL if the file could not be loaded
+	 */
+	chai3d::cGenericObject* instantiateMeshFile(const std::string& path,
+												const chai3d::cVector3d& scale,
+												chai3d::cMultiMesh*& base_mesh);
+
+	/**
+	 * @brief Loads the mesh files that are not in the cache yet in parallel,
+	 * so that the following calls to instantiateMeshFile for them only create
+	 * the instances. Decoding the files, scaling them and building their
+	 * levels of detail does not touch the chai world or OpenGL, so it can run
+	 * on worker threads, and the loaded meshes are added to the cache on the
+	 * calling thread. The obj and 3ds files, which can have textures, are
+	 * decoded one at a time, the rest of the work runs concurrently.
+	 *
+	 * @param requests mesh files to load, duplicates are loaded once
+	 * @param pool thread pool decoding the files, the parser uses a pool of
+	 * numLoadingThreads threads
+	 * @return the number of files loaded by this call
+	 */
+	unsigned int preloadMeshFiles(const std::vector<MeshFileRequest>& requests,
+								  SaiGraphics::ThreadPool& pool);
+
+	/// @brief function filling an empty mesh with a primitive shape
+	typedef std::function<void(chai3d::cMesh*)> PrimitiveBuilder;
+
+	/**
+	 * @brief Creates an instance of a primitive mesh, building the mesh the
+	 * first time this primitive is requested.
+	 *
+	 * @param type type of the primitive
+	 * @param parameters all the parameters the mesh of the primitive depends
+	 * on (dimensions, numbers of slices, vertex colors...)
+	 * @param build function creating the primitive in an empty mesh, only
+	 * called on the first request
+	 * @return the instance, with its own copy of the material of the mesh
+	 */
+	chai3d::cMesh* instantiatePrimitive(const std::string& type,
+										const std::vector<double>& parameters,
+										const PrimitiveBuilder& build);
+
+	/// @brief number of threads to use in preloadMeshFiles (0 for the number
+	/// of hardware threads)
+	unsigned int numLoadingThreads() const { return _num_loading_threads; }
+	void setNumLoadingThreads(const unsigned int num_loading_threads) {
+		_num_loading_threads = num_loading_threads;
+	}
+
+	/// @brief number of mesh files loaded
+	unsigned int numLoadedMeshes() const { return _meshes.size(); }
+
+	/// @brief number of different primitive meshes built
+	unsigned int numBuiltPrimitives() const { return _primitives.size(); }
+
+	/// @brief number of instances of mesh files created
+	unsigned int numInstances() const { return _num_instances; }
+
+	/// @brief number of instances of primitives created
+	unsigned int numPrimitiveInstances() const {
+		return _num_primitive_instances;
+	}
+
+	/// @brief deletes the loaded meshes and the primitive meshes
+	void clear();
+
+private:
+	typedef std::tuple<std::string, double, double, double> MeshKey;
+
+	/// @brief loaded meshes (chai3d::cMultiMesh or chai3d::cLevelOfDetail),
+	/// NULL for the files that could not be loaded
+	std::map<MeshKey, chai3d::cGenericObject*> _meshes;
+	unsigned int _num_instances = 0;
+
+	typedef std::pair<std::string, std::vector<double>> PrimitiveKey;
+
+	/// @brief primitive meshes
+	std::map<PrimitiveKey, chai3d::cMesh*> _primitives;
+	unsigned int _num_primitive_instances = 0;
+
+	unsigned int _num_loading_threads;
+};
+
+}  // namespace Parser
+
+#endif	// SAI_GRAPHICS_MESH_CACHE_H
@@ -0,0 +1,46 @@
+#include "Tessellation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace Parser {
+
+unsigned int TessellationSettings::numSlices(const double radius,
+											 const std::string& name) const {
+	double chord_error = max_chord_error;
+	auto it = max_chord_error_overrides.find(name);
+	if (it != max_chord_error_overrides.end()) {
+		chord_error = it->second;
+	}
+	if (radius <= chord_error) {
+		return min_slices;
+	}
+	// the chord error of n slices is radius * (1 - cos(pi / n))
+	const double slices = M_PI / acos(1.0 - chord_error / radius);
+	if (slices >= max_slices) {
+		return max_slices;
+	}
+	return std::max(min_slices, (unsigned int)ceil(slices));
+}
+
+void TessellationSettings::validate() const {
+	if (max_chord_error <= 0) {
+		throw std::invalid_argument(
+			"max_chord_error should be positive in TessellationSettings");
+	}
+	for (const auto& chord_error : max_chord_error_overrides) {
+		if (chord_error.second <= 0) {
+			throw std::invalid_argument(
+				"max chord error override of " + chord_error.first +
+				" should be positive in TessellationSettings");
+		}
+	}
+	if (min_slices < 3 || min_slices > max_slices) {
+		throw std::invalid_argument(
+			"min_slices should be at least 3 and at most max_slices in "
+			"TessellationSettings");
+	}
+}
+
+}  // namespace Parser
@@ -0,0 +1,60 @@
+/**
+ * \file Tessellation.h
+ *
+ * \brief Number of triangles used for the curved URDF primitives (spheres,
+ * cylinders and capsules), adapted to their size.
+ */
+
+#ifndef SAI_GRAPHICS_TESSELLATION_H
+#define SAI_GRAPHICS_TESSELLATION_H
+
+#include <map>
+#include <string>
+
+namespace Parser {
+
+/**
+ * @brief Quality of the tessellation of the curved primitives. The number of
+ * slices around each circle of a primitive is the smallest one for which the
+ * distance between the circle and its polygon (the chord error) is below a
+ * maximum error, so that small primitives get few triangles and large ones
+ * stay smooth.
+ */
+struct TessellationSettings {
+	/// @brief maximum chord error in meters
+	double max_chord_error = 2e-4;
+
+	/// @brief minimum number of slices around a circle
+	unsigned int min_slices = 8;
+
+	/// @brief maximum number of slices around a circle
+	unsigned int max_slices = 64;
+
+	/// @brief maximum chord error of the primitives of some links or objects,
+	/// by link or object name, replacing max_chord_error for them. The robots
+	/// are not distinguished: an override applies to the links of that name in
+	/// every robot, so all the robots loaded from the same model share it
+	std::map<std::string, double> max_chord_error_overrides;
+
+	/**
+	 * @brief Number of slices around a circle
+	 *
+	 * @param radius radius of the circle
+	 * @param name name of the link or object the primitive belongs to
+	 * @return the smallest number of slices within the chord error of the
+	 * object, clamped to [min_slices, max_slices]
+	 */
+	unsigned int numSlices(const double radius, const std::string& name) const;
+
+	/**
+	 * @brief Checks that the settings are valid
+	 *
+	 * @throw std::invalid_argument if a chord error is not positive, or if
+	 * min_slices is less than 3 or more than max_slices
+	 */
+	void validate() const;
+};
+
+}  // namespace Parser
+
+#endif	// SAI_GRAPHICS_TESSELLATION_H
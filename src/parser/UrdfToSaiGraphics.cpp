@@ -23,6 +23,8 @@ using namespace Eigen;
 
 #include <assert.h>
 
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <map>
@@ -57,12 +59,94 @@ static cGenericObject* getGenericObjectChildRecursive(
 	return NULL;
 }
 
+// internal helper function to get the path of a mesh file of a visual
+static std::string resolveMeshFilePath(const std::string& filename,
+									   const std::string& working_dirname) {
+	if (SaiModel::ReplaceUrdfPathPrefix(filename) != filename) {
+		return SaiModel::ReplaceUrdfPathPrefix(filename);
+	}
+	return working_dirname + "/" + filename;
+}
+
+// internal helper function to add the mesh file of a visual, if any, to the
+// files to load
+static void collectMeshFile(
+	const my_shared_ptr<SaiUrdfreader::Visual>& visual_ptr,
+	const std::string& working_dirname,
+	std::vector<MeshFileRequest>& mesh_files) {
+	if (visual_ptr->geometry->type != SaiUrdfreader::Geometry::MESH) {
+		return;
+	}
+	const auto mesh_ptr =
+		dynamic_cast<const SaiUrdfreader::Mesh*>(visual_ptr->geometry.get());
+	assert(mesh_ptr);
+	mesh_files.push_back(MeshFileRequest{
+		resolveMeshFilePath(mesh_ptr->filename, working_dirname),
+		cVector3d(mesh_ptr->scale.x, mesh_ptr->scale.y, mesh_ptr->scale.z)});
+}
+
+// internal helper function to add the mesh files of all the links of a robot
+// to the files to load
+static void collectRobotMeshFiles(const ModelPtr& urdf_model,
+								  const std::string& working_dirname,
+								  std::vector<MeshFileRequest>& mesh_files) {
+	for (const auto& link_pair : urdf_model->links_) {
+		for (const auto& visual_ptr : link_pair.second->visual_array) {
+			collectMeshFile(visual_ptr, working_dirname, mesh_files);
+		}
+	}
+}
+
+// internal helper function to decode the mesh files on the loading threads of
+// the cache before the chai tree is built
+static void preloadMeshFiles(MeshCache& mesh_cache,
+							 const std::vector<MeshFileRequest>& mesh_files,
+							 const std::string& caller, bool verbose) {
+	if (mesh_files.empty()) {
+		return;
+	}
+	const auto start_time = std::chrono::steady_clock::now();
+	SaiGraphics::ThreadPool pool(mesh_cache.numLoadingThreads());
+	const unsigned int num_loaded =
+		mesh_cache.preloadMeshFiles(mesh_files, pool);
+	if (verbose) {
+		const std::chrono::duration<double> duration =
+			std::chrono::steady_clock::now() - start_time;
+		cout << caller << ": loaded " << num_loaded << " mesh files in "
+			 << duration.count() << " s on " << pool.numThreads() << " threads."
+			 << endl;
+	}
+}
+
+// internal helper function to read and parse a robot urdf file
+static ModelPtr readRobotModel(const std::string& filepath) {
+	ifstream model_file(filepath);
+	if (!model_file) {
+		cerr << "Error opening file '" << filepath << "'." << endl;
+		abort();
+	}
+
+	// reserve memory for the contents of the file
+	string model_xml_string;
+	model_file.seekg(0, std::ios::end);
+	model_xml_string.reserve(model_file.tellg());
+	model_file.seekg(0, std::ios::beg);
+	model_xml_string.assign((std::istreambuf_iterator<char>(model_file)),
+							std::istreambuf_iterator<char>());
+
+	model_file.close();
+
+	// read and parse xml string to urdf model
+	return SaiUrdfreader::parseURDF(model_xml_string);
+}
+
 // internal helper function to load a SaiUrdfreader::Visual to a cGenericObject
 // TODO: working dir default should be "", but this requires checking
 // to make sure that the directory path has a trailing backslash
 static void loadVisualtoGenericObject(
 	cGenericObject* object,
 	const my_shared_ptr<SaiUrdfreader::Visual>& visual_ptr,
+	MeshCache& mesh_cache, const TessellationSettings& tessellation,
 	const std::string& working_dirname = "./") {
 	// parse material if specified
 	const auto material_ptr = visual_ptr->material;
@@ -73,11 +157,13 @@ static void loadVisualtoGenericObject(
 	}
 	// parse geometry if specified
 	const auto geom_type = visual_ptr->geometry->type;
-	auto tmp_mmesh = new cMultiMesh();
-	auto tmp_mesh = new cMesh();
-	if(color && color->getA() < 1.0){
-		tmp_mesh->setUseTransparency(true);
-	}
+	cMultiMesh* tmp_mmesh = NULL;
+	// object added to the parent, tmp_mmesh or the levels of detail
+	// containing it
+	cGenericObject* visual_object = NULL;
+	// primitive shapes are built once per set of parameters, and tmp_mesh is
+	// an instance sharing the vertices of that mesh
+	cMesh* tmp_mesh = NULL;
 	if (geom_type == SaiUrdfreader::Geometry::MESH) {
 		// downcast geometry ptr to mesh type
 		const auto mesh_ptr = dynamic_cast<const SaiUrdfreader::Mesh*>(
@@ -87,13 +173,8 @@ static void loadVisualtoGenericObject(
 		// load object
 		bool file_load_success = false;
 
-		std::string processed_filepath =
-			working_dirname + "/" + mesh_ptr->filename;
-		if (SaiModel::ReplaceUrdfPathPrefix(mesh_ptr->filename) !=
-			mesh_ptr->filename) {
-			processed_filepath =
-				SaiModel::ReplaceUrdfPathPrefix(mesh_ptr->filename);
-		}
+		const std::string processed_filepath =
+			resolveMeshFilePath(mesh_ptr->filename, working_dirname);
 
 		if (processed_filepath.length() < 5) {
 			cerr << "Couldn't load obj/3ds/STL robot link file, extension not "
@@ -102,27 +183,20 @@ static void loadVisualtoGenericObject(
 			abort();
 		}
 
-		std::string extension =
-			processed_filepath.substr(processed_filepath.length() - 4);
-		std::transform(extension.begin(), extension.end(), extension.begin(),
-					   [](unsigned char c) { return std::tolower(c); });
-
-		if (extension == ".stl") {
-			file_load_success = cLoadFileSTL(tmp_mmesh, processed_filepath);
-		} else if (extension == ".obj") {
-			file_load_success = cLoadFileOBJ(tmp_mmesh, processed_filepath);
-		} else if (extension == ".3ds") {
-			file_load_success = cLoadFile3DS(tmp_mmesh, processed_filepath);
-		}
+		// the file is loaded and scaled once for all the visuals using it
+		// (usually in parallel with the other files before the tree is built),
+		// and large meshes are drawn through decimated levels of detail
+		visual_object = mesh_cache.instantiateMeshFile(
+			processed_filepath,
+			cVector3d(mesh_ptr->scale.x, mesh_ptr->scale.y, mesh_ptr->scale.z),
+			tmp_mmesh);
+		file_load_success = visual_object != NULL;
 		if (!file_load_success) {
 			cerr << "Couldn't load obj/3ds/STL robot link file: "
 				 << processed_filepath << endl;
 			abort();
 		}
 
-		// apply scale
-		tmp_mmesh->scaleXYZ(mesh_ptr->scale.x, mesh_ptr->scale.y,
-							mesh_ptr->scale.z);
 		if (color) {
 			tmp_mmesh->m_material->setColor(*color);
 		}
@@ -132,102 +206,347 @@ static void loadVisualtoGenericObject(
 			visual_ptr->geometry.get());
 		assert(box_ptr);
 		// create chai box mesh
-		cCreateBox(tmp_mesh, box_ptr->dim.x, box_ptr->dim.y, box_ptr->dim.z);
+		tmp_mesh = mesh_cache.instantiatePrimitive(
+			"box", {box_ptr->dim.x, box_ptr->dim.y, box_ptr->dim.z},
+			[&](cMesh* mesh) {
+				cCreateBox(mesh, box_ptr->dim.x, box_ptr->dim.y,
+						   box_ptr->dim.z);
+			});
 		if (color) {
 			tmp_mesh->m_material->setColor(*color);
 		}
-		tmp_mmesh->addMesh(tmp_mesh);
 	} else if (geom_type == SaiUrdfreader::Geometry::SPHERE) {
 		// downcast geometry ptr to sphere type
 		const auto sphere_ptr = dynamic_cast<const SaiUrdfreader::Sphere*>(
 			visual_ptr->geometry.get());
 		assert(sphere_ptr);
 		// create chai sphere mesh
-		cCreateSphere(tmp_mesh, sphere_ptr->radius);
+		const unsigned int slices =
+			tessellation.numSlices(sphere_ptr->radius, object->m_name);
+		const unsigned int stacks = std::max(slices / 2, (unsigned int)3);
+		tmp_mesh = mesh_cache.instantiatePrimitive(
+			"sphere", {sphere_ptr->radius, (double)slices, (double)stacks},
+			[&](cMesh* mesh) {
+				cCreateSphere(mesh, sphere_ptr->radius, slices, stacks);
+			});
 		if (color) {
 			tmp_mesh->m_material->setColor(*color);
 		}
-		tmp_mmesh->addMesh(tmp_mesh);
 	} else if (geom_type == SaiUrdfreader::Geometry::CYLINDER) {
 		// downcast geometry ptr to cylinder type
 		const auto cylinder_ptr = dynamic_cast<const SaiUrdfreader::Cylinder*>(
 			visual_ptr->geometry.get());
 		assert(cylinder_ptr);
 		// create chai cylinder mesh
-		chai3d::cCreateCylinder(tmp_mesh, cylinder_ptr->length,
-								cylinder_ptr->radius, 32, 1, 1, true, true,
-								cVector3d(0, 0, -cylinder_ptr->length / 2));
+		const unsigned int slices =
+			tessellation.numSlices(cylinder_ptr->radius, object->m_name);
+		tmp_mesh = mesh_cache.instantiatePrimitive(
+			"cylinder",
+			{cylinder_ptr->length, cylinder_ptr->radius, (double)slices},
+			[&](cMesh* mesh) {
+				chai3d::cCreateCylinder(
+					mesh, cylinder_ptr->length, cylinder_ptr->radius, slices,
+					1, 1, true, true,
+					cVector3d(0, 0, -cylinder_ptr->length / 2));
+			});
 		if (color) {
 			tmp_mesh->m_material->setColor(*color);
 		}
-		tmp_mmesh->addMesh(tmp_mesh);
 	} else if (geom_type == SaiUrdfreader::Geometry::CAPSULE) {
 		// downcast geometry ptr to cylinder type
 		const auto capsule_ptr = dynamic_cast<const SaiUrdfreader::Capsule*>(
 			visual_ptr->geometry.get());
 		assert(capsule_ptr);
+		// slices along the line segment about as far apart as around it
+		const unsigned int num_circumferential_slices =
+			tessellation.numSlices(capsule_ptr->radius, object->m_name);
+		const unsigned int num_longitudinal_slices = std::min(
+			tessellation.max_slices,
+			2 + (unsigned int)(capsule_ptr->length *
+							   num_circumferential_slices /
+							   (2.0 * M_PI * capsule_ptr->radius)));
+		std::vector<double> parameters = {capsule_ptr->radius,
+										  capsule_ptr->length,
+										  (double)num_longitudinal_slices,
+										  (double)num_circumferential_slices};
 		if (color) {
 			if (material_ptr && material_ptr->has_color2) {
-				auto color2 =
-					new cColorf(material_ptr->color2.r, material_ptr->color2.g,
-								material_ptr->color2.b, material_ptr->color2.a);
-				chai3d::cCreateCapsule(tmp_mesh, capsule_ptr->radius,
-									   capsule_ptr->length,
-									   20, /* a_num_longitudinal_slices */
-									   16, /* a_num_circumferential_slices */
-									   *color, *color2);
+				// the gradient is in the vertex colors, so it is part of the
+				// parameters of the mesh
+				const cColorf color1 = *color;
+				const cColorf color2(
+					material_ptr->color2.r, material_ptr->color2.g,
+					material_ptr->color2.b, material_ptr->color2.a);
+				parameters.insert(
+					parameters.end(),
+					{color1.getR(), color1.getG(), color1.getB(),
+					 color1.getA(), color2.getR(), color2.getG(),
+					 color2.getB(), color2.getA()});
+				tmp_mesh = mesh_cache.instantiatePrimitive(
+					"capsule", parameters, [&](cMesh* mesh) {
+						chai3d::cCreateCapsule(
+							mesh, capsule_ptr->radius, capsule_ptr->length,
+							num_longitudinal_slices,
+							num_circumferential_slices, color1, color2);
+					});
 				// if dual color information is present, we use the bicolor
 				// gradient rendering of the capsule which requires vertex
 				// coloring
 				tmp_mesh->setUseVertexColors(true, true);
 			} else {
-				chai3d::cCreateCapsule(tmp_mesh, capsule_ptr->radius,
-									   capsule_ptr->length);
+				tmp_mesh = mesh_cache.instantiatePrimitive(
+					"capsule", parameters, [&](cMesh* mesh) {
+						chai3d::cCreateCapsule(
+							mesh, capsule_ptr->radius, capsule_ptr->length,
+							num_longitudinal_slices,
+							num_circumferential_slices);
+					});
 				// vertex coloring not needed, we set the material property
 				tmp_mesh->m_material->setColor(*color);
 			}
 		} else {
-			chai3d::cCreateCapsule(tmp_mesh, capsule_ptr->radius,
-								   capsule_ptr->length);
+			tmp_mesh = mesh_cache.instantiatePrimitive(
+				"capsule", parameters, [&](cMesh* mesh) {
+					chai3d::cCreateCapsule(mesh, capsule_ptr->radius,
+										   capsule_ptr->length,
+										   num_longitudinal_slices,
+										   num_circumferential_slices);
+				});
 			// if no color information is present, we use the default rendering
 			// of the capsule which has a vertex coloring based bicolor gradient
 			tmp_mesh->setUseVertexColors(true, true);
 		}
-		tmp_mmesh->addMesh(tmp_mesh);
 	} else if (geom_type == SaiUrdfreader::Geometry::PYRAMID) {
 		// downcast geometry ptr to pyramid type
 		const auto pyramid_ptr = dynamic_cast<const SaiUrdfreader::Pyramid*>(
 			visual_ptr->geometry.get());
 		assert(pyramid_ptr);
-		chai3d::cCreatePyramid(tmp_mesh, pyramid_ptr->num_sides,
-							   pyramid_ptr->base_size, pyramid_ptr->height,
-							   pyramid_ptr->use_center_vertex);
+		tmp_mesh = mesh_cache.instantiatePrimitive(
+			"pyramid",
+			{(double)pyramid_ptr->num_sides, pyramid_ptr->base_size,
+			 pyramid_ptr->height, (double)pyramid_ptr->use_center_vertex},
+			[&](cMesh* mesh) {
+				chai3d::cCreatePyramid(mesh, pyramid_ptr->num_sides,
+									   pyramid_ptr->base_size,
+									   pyramid_ptr->height,
+									   pyramid_ptr->use_center_vertex);
+			});
 		if (color) {
 			tmp_mesh->m_material->setColor(*color);
 		}
+	}
+	if (visual_object == NULL) {
+		// primitive shape, in its own multi mesh
+		if (tmp_mesh == NULL) {
+			tmp_mesh = new cMesh();
+		}
+		if (color && color->getA() < 1.0) {
+			tmp_mesh->setUseTransparency(true);
+		}
+		tmp_mmesh = new cMultiMesh();
 		tmp_mmesh->addMesh(tmp_mesh);
+		visual_object = tmp_mmesh;
 	}
 	if (color) {
 		delete color;
 	}
+	// create brute force collision detector
+	tmp_mmesh->createBruteForceCollisionDetector();
+	tmp_mmesh->m_name = object->m_name;
+	visual_object->m_name = object->m_name;
 	// set position and orientation for mesh
-	tmp_mmesh->setLocalPos(cVector3d(visual_ptr->origin.position.x,
-									 visual_ptr->origin.position.y,
-									 visual_ptr->origin.position.z));
+	visual_object->setLocalPos(cVector3d(visual_ptr->origin.position.x,
+										 visual_ptr->origin.position.y,
+										 visual_ptr->origin.position.z));
 	{  // brace temp variables to separate scope
 		auto urdf_q = visual_ptr->origin.rotation;
 		Quaternion<double> tmp_q(urdf_q.w, urdf_q.x, urdf_q.y, urdf_q.z);
 		cMatrix3d tmp_cmat3;
 		tmp_cmat3.copyfrom(tmp_q.toRotationMatrix());
-		tmp_mmesh->setLocalRot(tmp_cmat3);
+		visual_object->setLocalRot(tmp_cmat3);
 	}
-	// create brute force collision detector
-	tmp_mmesh->createBruteForceCollisionDetector();
-	tmp_mmesh->m_name = object->m_name;
 	// add as child to object model
-	object->addChild(tmp_mmesh);
+	object->addChild(visual_object);
+}
+
+// internal helper function to populate a chai3d robot model from a parsed urdf
+// model. The mesh files that were not preloaded are loaded on the fly
+static void urdfModelToSaiGraphicsRobot(
+	const ModelPtr& urdf_model, chai3d::cRobotBase* base, bool verbose,
+	const std::string& working_dirname, MeshCache& mesh_cache,
+	const TessellationSettings& tessellation) {
+	assert(base);
+	base->m_name = urdf_model->getName();
+	if (verbose) {
+		cout << "UrdfToSaiGraphicsRobot: Starting model conversion to chai."
+			 << endl;
+		cout << "+ add robot: " << base->m_name << endl;
+	}
+
+	// load urdf model to dynamics3D link tree
+	LinkPtr urdf_root_link;
+
+	URDFLinkMap link_map;  // map<string, LinkPtr >
+	link_map = urdf_model->links_;
+
+	URDFJointMap joint_map;	 // map<string, JointPtr >
+	joint_map = urdf_model->joints_;
+
+	vector<string> joint_names;
+
+	stack<LinkPtr> link_stack;
+	stack<int> joint_index_stack;
+
+	// add the bodies in a depth-first order of the model tree
+	// push the root LinkPtr to link stack. link stack height = 1
+	// NOTE: depth first search happens due to use of stack
+	link_stack.push(link_map[(urdf_model->getRoot()->name)]);
+
+	// add the root body
+	ConstLinkPtr& root = urdf_model->getRoot();
+
+	// TODO: Not sure if this is ever expected to be true or not
+	// 	Mikael's example URDF has it set to false
+	if (root->visual) {
+		// initialize a cRobotLink for the root link
+		cRobotLink* root_object = new cRobotLink();
+		root_object->m_name = root->name;
+
+		// add to base
+		base->addChild(root_object);
+
+		// parse visual meshes
+		for (const auto visual_ptr : root->visual_array) {
+			loadVisualtoGenericObject(root_object, visual_ptr, mesh_cache,
+									  tessellation, working_dirname);
+		}
+
+		if (verbose) {
+			cout << "+ Adding Root Body to chai render" << endl;
+			cout << "  body name   : " << root_object->m_name << endl;
+		}
+	}  // endif (root->visual)
+
+	if (link_stack.top()->child_joints.size() > 0) {
+		joint_index_stack.push(0);	// SG: what does this do??
+	} else {
+		cerr << "Base link has no associated joints!" << endl;
+		abort();
+	}
+
+	// this while loop is to enumerate all joints in the tree structure by name
+	while (link_stack.size() > 0) {
+		LinkPtr cur_link = link_stack.top();
+		unsigned int joint_idx = joint_index_stack.top();
+
+		// if there are unvisited child joints on current link:
+		// 	then add link to stack
+		if (joint_idx < cur_link->child_joints.size()) {
+			JointPtr cur_joint = cur_link->child_joints[joint_idx];
+
+			// increment joint index
+			joint_index_stack.pop();
+			joint_index_stack.push(joint_idx + 1);
+
+			// SG: the URDF model structure is:
+			//	every non-terminal link has child joint(s)
+			// 	every joint has child link (else, we would get an exception
+			// right below)
+			link_stack.push(link_map[cur_joint->child_link_name]);
+			joint_index_stack.push(0);
+
+			if (verbose) {
+				for (unsigned int i = 1; i < joint_index_stack.size() - 1;
+					 i++) {
+					cout << "  ";
+				}
+				cout << "joint '" << cur_joint->name << "' child link '"
+					 << link_stack.top()->name << "' type = " << cur_joint->type
+					 << endl;
+			}
+
+			joint_names.push_back(cur_joint->name);
+			// SG: this is the only data structure of interest it seems
+			// all joints are processed in the for loop below
+		} else {  // else this link has been processed, so pop link
+			link_stack.pop();
+			joint_index_stack.pop();
+		}
+	}
+
+	// iterate over all joints
+	for (unsigned int j = 0; j < joint_names.size(); j++) {
+		JointPtr urdf_joint = joint_map[joint_names[j]];
+		LinkPtr urdf_parent = link_map[urdf_joint->parent_link_name];
+		LinkPtr urdf_child = link_map[urdf_joint->child_link_name];
+
+		// determine where to add the current joint and child body
+		cRobotLink* parent_link = NULL;
+		parent_link = dynamic_cast<cRobotLink*>(getGenericObjectChildRecursive(
+			urdf_parent->name, base));	// returns NULL if link does not exist
+
+		// cout << "joint: " << urdf_joint->name << "\tparent = " <<
+		// urdf_parent->name << " child = " << urdf_child->name << " parent_id =
+		// " << rbdl_parent_id << endl;
+
+		// create a new link
+		cRobotLink* link = new cRobotLink();
+		link->m_name = urdf_child->name;
+
+		// load visuals
+		for (const auto visual_ptr : urdf_child->visual_array) {
+			loadVisualtoGenericObject(link, visual_ptr, mesh_cache,
+									  tessellation, working_dirname);
+		}
+
+		// compute the joint transformation which acts as the child link
+		// transform with respect to the parent
+		Vector3d joint_rpy;
+		Vector3d joint_translation;
+		urdf_joint->parent_to_joint_origin_transform.rotation.getRPY(
+			joint_rpy[0], joint_rpy[1], joint_rpy[2]);
+		joint_translation
+			<< urdf_joint->parent_to_joint_origin_transform.position.x,
+			urdf_joint->parent_to_joint_origin_transform.position.y,
+			urdf_joint->parent_to_joint_origin_transform.position.z;
+		auto urdf_q = urdf_joint->parent_to_joint_origin_transform.rotation;
+		Quaternion<double> tmp_q(urdf_q.w, urdf_q.x, urdf_q.y, urdf_q.z);
+		cMatrix3d rot_in_parent;
+		rot_in_parent.copyfrom(tmp_q.toRotationMatrix());
+		link->setLocalPos(joint_translation);
+		link->setLocalRot(rot_in_parent);
+
+		// add to parent link
+		if (NULL == parent_link) {
+			// link is located at root
+			base->addChild(link);
+		} else {
+			// link to parent
+			parent_link->addChild(link);
+		}
+
+		if (verbose) {
+			cout << "+ Adding Body " << endl;
+			if (NULL == parent_link) {
+				cout << "  parent_link_name  : NULL" << endl;
+			} else {
+				cout << "  parent_link_name  : " << parent_link->m_name << endl;
+			}
+			cout << "  position in parent: " << joint_translation.transpose()
+				 << endl;
+			cout << "  orientation in parent: " << tmp_q.coeffs().transpose()
+				 << endl;
+			cout << "  body name   : " << link->m_name << endl;
+		}
+	}
+
+	if (verbose) {
+		cout << "UrdfToSaiGraphicsRobot: Finished model conversion to chai."
+			 << endl;
+	}
 }
 
+
 void UrdfToSaiGraphicsWorld(
 	const std::string& filename, chai3d::cWorld* world,
 	std::map<std::string, std::string>& robot_filenames,
@@ -235,7 +554,19 @@ void UrdfToSaiGraphicsWorld(
 	std::map<std::string, std::shared_ptr<Eigen::Affine3d>>&
 		static_object_poses,
 	std::map<std::string, cFrameBufferPtr>& camera_frame_buffers,
-	bool verbose) {
+	bool verbose, MeshCache* mesh_cache,
+	const TessellationSettings* tessellation) {
+	// the visuals of the world share a cache if none is given
+	MeshCache world_mesh_cache;
+	if (mesh_cache == NULL) {
+		mesh_cache = &world_mesh_cache;
+	}
+	const TessellationSettings default_tessellation;
+	if (tessellation == NULL) {
+		tessellation = &default_tessellation;
+	}
+	tessellation->validate();
+
 	// load world urdf file
 	std::string resolved_filename = SaiModel::ReplaceUrdfPathPrefix(filename);
 	ifstream model_file(resolved_filename);
@@ -265,7 +596,34 @@ void UrdfToSaiGraphicsWorld(
 		cout << "+ add world: " << world->m_name << endl;
 	}
 
+	// parse the robot files and gather the mesh files of the robots and
+	// objects, which are decoded in parallel before the tree is built
+	std::vector<MeshFileRequest> mesh_files;
+	std::vector<ModelPtr> robot_models;
+	for (const auto robot_spec_pair : urdf_world->models_) {
+		const auto robot_spec = robot_spec_pair.second;
+		const std::string working_dirname =
+			SaiModel::ReplaceUrdfPathPrefix(robot_spec->model_working_dir);
+		robot_models.push_back(readRobotModel(working_dirname + "/" +
+											  robot_spec->model_filename));
+		collectRobotMeshFiles(robot_models.back(), working_dirname,
+							  mesh_files);
+	}
+	for (const auto object_pair : urdf_world->graphics_.static_objects) {
+		for (const auto visual_ptr : object_pair.second->visual_array) {
+			collectMeshFile(visual_ptr, "./", mesh_files);
+		}
+	}
+	for (const auto object_pair : urdf_world->graphics_.dynamic_objects) {
+		for (const auto visual_ptr : object_pair.second->visual_array) {
+			collectMeshFile(visual_ptr, "./", mesh_files);
+		}
+	}
+	preloadMeshFiles(*mesh_cache, mesh_files, "UrdfToSaiGraphicsWorld",
+					 verbose);
+
 	// parse robots
+	unsigned int robot_index = 0;
 	for (const auto robot_spec_pair : urdf_world->models_) {
 		const auto robot_spec = robot_spec_pair.second;
 
@@ -285,10 +643,11 @@ void UrdfToSaiGraphicsWorld(
 		robot->setLocalRot(tmp_cmat3);
 		world->addChild(robot);
 
-		// load robot from file
-		UrdfToSaiGraphicsRobot(
-			robot_spec->model_filename, robot, verbose,
-			SaiModel::ReplaceUrdfPathPrefix(robot_spec->model_working_dir));
+		// load robot from its parsed file
+		urdfModelToSaiGraphicsRobot(
+			robot_models[robot_index++], robot, verbose,
+			SaiModel::ReplaceUrdfPathPrefix(robot_spec->model_working_dir),
+			*mesh_cache, *tessellation);
 		assert(robot->m_name == robot_spec->model_name);
 
 		// overwrite robot name with custom name for this instance
@@ -316,7 +675,7 @@ void UrdfToSaiGraphicsWorld(
 
 		// initialize a chai camera
 		cCamera* camera = new cCamera(world);
-		cFrameBufferPtr fb = cFrameBuffer::create();
+		cFrameBufferPtr fb = cCaptureFrameBuffer::create();
 		fb->setup(camera);
 		camera_frame_buffers[camera_ptr->name] = fb;
 		// TODO: support link mounted camera
@@ -419,7 +778,8 @@ void UrdfToSaiGraphicsWorld(
 				 << " has no visual element." << endl;
 		}
 		for (const auto visual_ptr : object_ptr->visual_array) {
-			loadVisualtoGenericObject(object, visual_ptr);
+			loadVisualtoGenericObject(object, visual_ptr, *mesh_cache,
+									  *tessellation);
 		}
 	}
 
@@ -460,201 +820,47 @@ void UrdfToSaiGraphicsWorld(
 				"element.");
 		}
 		for (const auto visual_ptr : object_ptr->visual_array) {
-			loadVisualtoGenericObject(object, visual_ptr);
+			loadVisualtoGenericObject(object, visual_ptr, *mesh_cache,
+									  *tessellation);
 		}
 	}
-}
-
-void UrdfToSaiGraphicsRobot(const std::string& filename,
-							 chai3d::cRobotBase* base, bool verbose,
-							 const std::string& working_dirname) {
-	// load and parse model file
-	string filepath = working_dirname + "/" + filename;
-	ifstream model_file(filepath);
-	if (!model_file) {
-		cerr << "Error opening file '" << filepath << "'." << endl;
-		abort();
-	}
-
-	// reserve memory for the contents of the file
-	string model_xml_string;
-	model_file.seekg(0, std::ios::end);
-	model_xml_string.reserve(model_file.tellg());
-	model_file.seekg(0, std::ios::beg);
-	model_xml_string.assign((std::istreambuf_iterator<char>(model_file)),
-							std::istreambuf_iterator<char>());
 
-	model_file.close();
-
-	// read and parse xml string to urdf model
-	assert(base);
-	ModelPtr urdf_model = SaiUrdfreader::parseURDF(model_xml_string);
-	base->m_name = urdf_model->getName();
 	if (verbose) {
-		cout << "UrdfToSaiGraphicsRobot: Starting model conversion to chai."
+		cout << "UrdfToSaiGraphicsWorld: " << mesh_cache->numLoadedMeshes()
+			 << " mesh files loaded for " << mesh_cache->numInstances()
+			 << " mesh visuals." << endl;
+		cout << "UrdfToSaiGraphicsWorld: " << mesh_cache->numBuiltPrimitives()
+			 << " primitive meshes built for "
+			 << mesh_cache->numPrimitiveInstances() << " primitive visuals."
 			 << endl;
-		cout << "+ add robot: " << base->m_name << endl;
-	}
-
-	// load urdf model to dynamics3D link tree
-	LinkPtr urdf_root_link;
-
-	URDFLinkMap link_map;  // map<string, LinkPtr >
-	link_map = urdf_model->links_;
-
-	URDFJointMap joint_map;	 // map<string, JointPtr >
-	joint_map = urdf_model->joints_;
-
-	vector<string> joint_names;
-
-	stack<LinkPtr> link_stack;
-	stack<int> joint_index_stack;
-
-	// add the bodies in a depth-first order of the model tree
-	// push the root LinkPtr to link stack. link stack height = 1
-	// NOTE: depth first search happens due to use of stack
-	link_stack.push(link_map[(urdf_model->getRoot()->name)]);
-
-	// add the root body
-	ConstLinkPtr& root = urdf_model->getRoot();
-
-	// TODO: Not sure if this is ever expected to be true or not
-	// 	Mikael's example URDF has it set to false
-	if (root->visual) {
-		// initialize a cRobotLink for the root link
-		cRobotLink* root_object = new cRobotLink();
-		root_object->m_name = root->name;
-
-		// add to base
-		base->addChild(root_object);
-
-		// parse visual meshes
-		for (const auto visual_ptr : root->visual_array) {
-			loadVisualtoGenericObject(root_object, visual_ptr, working_dirname);
-		}
-
-		if (verbose) {
-			cout << "+ Adding Root Body to chai render" << endl;
-			cout << "  body name   : " << root_object->m_name << endl;
-		}
-	}  // endif (root->visual)
-
-	if (link_stack.top()->child_joints.size() > 0) {
-		joint_index_stack.push(0);	// SG: what does this do??
-	} else {
-		cerr << "Base link has no associated joints!" << endl;
-		abort();
 	}
+}
 
-	// this while loop is to enumerate all joints in the tree structure by name
-	while (link_stack.size() > 0) {
-		LinkPtr cur_link = link_stack.top();
-		unsigned int joint_idx = joint_index_stack.top();
-
-		// if there are unvisited child joints on current link:
-		// 	then add link to stack
-		if (joint_idx < cur_link->child_joints.size()) {
-			JointPtr cur_joint = cur_link->child_joints[joint_idx];
-
-			// increment joint index
-			joint_index_stack.pop();
-			joint_index_stack.push(joint_idx + 1);
-
-			// SG: the URDF model structure is:
-			//	every non-terminal link has child joint(s)
-			// 	every joint has child link (else, we would get an exception
-			// right below)
-			link_stack.push(link_map[cur_joint->child_link_name]);
-			joint_index_stack.push(0);
-
-			if (verbose) {
-				for (unsigned int i = 1; i < joint_index_stack.size() - 1;
-					 i++) {
-					cout << "  ";
-				}
-				cout << "joint '" << cur_joint->name << "' child link '"
-					 << link_stack.top()->name << "' type = " << cur_joint->type
-					 << endl;
-			}
-
-			joint_names.push_back(cur_joint->name);
-			// SG: this is the only data structure of interest it seems
-			// all joints are processed in the for loop below
-		} else {  // else this link has been processed, so pop link
-			link_stack.pop();
-			joint_index_stack.pop();
-		}
+void UrdfToSaiGraphicsRobot(const std::string& filename,
+							 chai3d::cRobotBase* base, bool verbose,
+							 const std::string& working_dirname,
+							 MeshCache* mesh_cache,
+							 const TessellationSettings* tessellation) {
+	MeshCache robot_mesh_cache;
+	if (mesh_cache == NULL) {
+		mesh_cache = &robot_mesh_cache;
 	}
-
-	// iterate over all joints
-	for (unsigned int j = 0; j < joint_names.size(); j++) {
-		JointPtr urdf_joint = joint_map[joint_names[j]];
-		LinkPtr urdf_parent = link_map[urdf_joint->parent_link_name];
-		LinkPtr urdf_child = link_map[urdf_joint->child_link_name];
-
-		// determine where to add the current joint and child body
-		cRobotLink* parent_link = NULL;
-		parent_link = dynamic_cast<cRobotLink*>(getGenericObjectChildRecursive(
-			urdf_parent->name, base));	// returns NULL if link does not exist
-
-		// cout << "joint: " << urdf_joint->name << "\tparent = " <<
-		// urdf_parent->name << " child = " << urdf_child->name << " parent_id =
-		// " << rbdl_parent_id << endl;
-
-		// create a new link
-		cRobotLink* link = new cRobotLink();
-		link->m_name = urdf_child->name;
-
-		// load visuals
-		for (const auto visual_ptr : urdf_child->visual_array) {
-			loadVisualtoGenericObject(link, visual_ptr, working_dirname);
-		}
-
-		// compute the joint transformation which acts as the child link
-		// transform with respect to the parent
-		Vector3d joint_rpy;
-		Vector3d joint_translation;
-		urdf_joint->parent_to_joint_origin_transform.rotation.getRPY(
-			joint_rpy[0], joint_rpy[1], joint_rpy[2]);
-		joint_translation
-			<< urdf_joint->parent_to_joint_origin_transform.position.x,
-			urdf_joint->parent_to_joint_origin_transform.position.y,
-			urdf_joint->parent_to_joint_origin_transform.position.z;
-		auto urdf_q = urdf_joint->parent_to_joint_origin_transform.rotation;
-		Quaternion<double> tmp_q(urdf_q.w, urdf_q.x, urdf_q.y, urdf_q.z);
-		cMatrix3d rot_in_parent;
-		rot_in_parent.copyfrom(tmp_q.toRotationMatrix());
-		link->setLocalPos(joint_translation);
-		link->setLocalRot(rot_in_parent);
-
-		// add to parent link
-		if (NULL == parent_link) {
-			// link is located at root
-			base->addChild(link);
-		} else {
-			// link to parent
-			parent_link->addChild(link);
-		}
-
-		if (verbose) {
-			cout << "+ Adding Body " << endl;
-			if (NULL == parent_link) {
-				cout << "  parent_link_name  : NULL" << endl;
-			} else {
-				cout << "  parent_link_name  : " << parent_link->m_name << endl;
-			}
-			cout << "  position in parent: " << joint_translation.transpose()
-				 << endl;
-			cout << "  orientation in parent: " << tmp_q.coeffs().transpose()
-				 << endl;
-			cout << "  body name   : " << link->m_name << endl;
-		}
+	const TessellationSettings default_tessellation;
+	if (tessellation == NULL) {
+		tessellation = &default_tessellation;
 	}
+	tessellation->validate();
 
-	if (verbose) {
-		cout << "UrdfToSaiGraphicsRobot: Finished model conversion to chai."
-			 << endl;
-	}
+	// load and parse model file
+	ModelPtr urdf_model = readRobotModel(working_dirname + "/" + filename);
+
+	// decode the mesh files in parallel, then build the links
+	std::vector<MeshFileRequest> mesh_files;
+	collectRobotMeshFiles(urdf_model, working_dirname, mesh_files);
+	preloadMeshFiles(*mesh_cache, mesh_files, "UrdfToSaiGraphicsRobot",
+					 verbose);
+	urdfModelToSaiGraphicsRobot(urdf_model, base, verbose, working_dirname,
+								*mesh_cache, *tessellation);
 }
 
 }  // namespace Parser
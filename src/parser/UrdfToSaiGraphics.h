@@ -10,10 +10,14 @@
 
 #include <chai3d.h>
 
+#include "chai_extension/CCaptureFrameBuffer.h"
 #include "chai_extension/CRobotBase.h"
 #include "chai_extension/CRobotLink.h"
 #include "chai_extension/Capsule.h"
+#include "chai_extension/LevelOfDetail.h"
 #include "chai_extension/Pyramid.h"
+#include "parser/MeshCache.h"
+#include "parser/Tessellation.h"
 
 namespace Parser {
 /**
@@ -22,6 +26,10 @@ namespace Parser {
  * @param world chai3d::cWorld model to populate from parsed file.
  * @param verbose To display information about the robot model creation in the
  * terminal or not.
+ * @param mesh_cache Cache of the mesh files, shared by all the robots and
+ * objects. A cache local to this call is used if NULL.
+ * @param tessellation Tessellation of the spheres, cylinders and capsules of
+ * all the robots and objects. The default settings are used if NULL.
  */
 void UrdfToSaiGraphicsWorld(
 	const std::string& filename, chai3d::cWorld* world,
@@ -29,7 +37,9 @@ void UrdfToSaiGraphicsWorld(
 	std::map<std::string, std::shared_ptr<Eigen::Affine3d>>& dyn_object_poses,
 	std::map<std::string, std::shared_ptr<Eigen::Affine3d>>&
 		static_object_poses,
-	std::map<std::string, chai3d::cFrameBufferPtr>& camera_frame_buffers, bool verbose);
+	std::map<std::string, chai3d::cFrameBufferPtr>& camera_frame_buffers,
+	bool verbose, MeshCache* mesh_cache = NULL,
+	const TessellationSettings* tessellation = NULL);
 
 /**
  * @brief Parse a URDF file and populate a single chai3d robot model from it.
@@ -39,10 +49,16 @@ void UrdfToSaiGraphicsWorld(
  * terminal or not.
  * @param working_dirname Directory path relative to which paths within the
  * model file are specified.
+ * @param mesh_cache Cache of the mesh files. A cache local to this call is
+ * used if NULL.
+ * @param tessellation Tessellation of the spheres, cylinders and capsules. The
+ * default settings are used if NULL.
  */
 void UrdfToSaiGraphicsRobot(const std::string& filename,
 							 chai3d::cRobotBase* base, bool verbose,
-							 const std::string& working_dirname = "./");
+							 const std::string& working_dirname = "./",
+							 MeshCache* mesh_cache = NULL,
+							 const TessellationSettings* tessellation = NULL);
 // TODO: working dir default should be "", but this requires checking
 // to make sure that the directory path has a trailing backslash
 
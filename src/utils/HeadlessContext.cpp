@@ -0,0 +1,160 @@
+#include "HeadlessContext.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifdef SAI_GRAPHICS_USE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+namespace SaiGraphics {
+
+#ifdef SAI_GRAPHICS_USE_EGL
+
+namespace {
+
+bool hasExtension(const char* extensions, const char* name) {
+	if (extensions == NULL) {
+		return false;
+	}
+	const size_t length = strlen(name);
+	const char* start = extensions;
+	while ((start = strstr(start, name)) != NULL) {
+		const char end = start[length];
+		if ((start == extensions || start[-1] == ' ') &&
+			(end == ' ' || end == '\0')) {
+			return true;
+		}
+		start += length;
+	}
+	return false;
+}
+
+EGLDisplay getHeadlessDisplay() {
+	// prefer the surfaceless platform that does not need any display server
+	const char* client_extensions =
+		eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+	if (hasExtension(client_extensions, "EGL_MESA_platform_surfaceless")) {
+		auto get_platform_display =
+			(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress(
+				"eglGetPlatformDisplayEXT");
+		if (get_platform_display != NULL) {
+			EGLDisplay display = get_platform_display(
+				EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+			if (display != EGL_NO_DISPLAY &&
+				eglInitialize(display, NULL, NULL)) {
+				return display;
+			}
+		}
+	}
+	EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL)) {
+		throw std::runtime_error(
+			"could not initialize an EGL display in HeadlessContext");
+	}
+	return display;
+}
+
+}  // namespace
+
+HeadlessContext::HeadlessContext()
+	: _display(EGL_NO_DISPLAY),
+	  _context(EGL_NO_CONTEXT),
+	  _surface(EGL_NO_SURFACE) {
+	EGLDisplay display = getHeadlessDisplay();
+	_display = display;
+
+	const EGLint config_attributes[] = {EGL_SURFACE_TYPE,
+										EGL_PBUFFER_BIT,
+										EGL_RENDERABLE_TYPE,
+										EGL_OPENGL_BIT,
+										EGL_RED_SIZE,
+										8,
+										EGL_GREEN_SIZE,
+										8,
+										EGL_BLUE_SIZE,
+										8,
+										EGL_DEPTH_SIZE,
+										24,
+										EGL_NONE};
+	EGLConfig config;
+	EGLint num_configs = 0;
+	if (!eglChooseConfig(display, config_attributes, &config, 1,
+						 &num_configs) ||
+		num_configs == 0) {
+		eglTerminate(display);
+		throw std::runtime_error(
+			"no EGL config supporting desktop OpenGL in HeadlessContext");
+	}
+
+	// chai3d uses the fixed function pipeline, so we need a desktop OpenGL
+	// (compatibility) context
+	if (!eglBindAPI(EGL_OPENGL_API)) {
+		eglTerminate(display);
+		throw std::runtime_error(
+			"could not bind the OpenGL API in HeadlessContext");
+	}
+	EGLContext context =
+		eglCreateContext(display, config, EGL_NO_CONTEXT, NULL);
+	if (context == EGL_NO_CONTEXT) {
+		eglTerminate(display);
+		throw std::runtime_error(
+			"could not create the EGL context in HeadlessContext");
+	}
+	_context = context;
+
+	// without surfaceless support, bind a small pbuffer that is never used
+	const char* display_extensions = eglQueryString(display, EGL_EXTENSIONS);
+	if (!hasExtension(display_extensions, "EGL_KHR_surfaceless_context")) {
+		const EGLint pbuffer_attributes[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1,
+											 EGL_NONE};
+		_surface = eglCreatePbufferSurface(display, config, pbuffer_attributes);
+		if (_surface == EGL_NO_SURFACE) {
+			eglDestroyContext(display, context);
+			eglTerminate(display);
+			throw std::runtime_error(
+				"could not create the EGL pbuffer surface in HeadlessContext");
+		}
+	}
+	makeCurrent();
+}
+
+HeadlessContext::~HeadlessContext() {
+	eglMakeCurrent(_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	if (_surface != EGL_NO_SURFACE) {
+		eglDestroySurface(_display, _surface);
+	}
+	eglDestroyContext(_display, _context);
+	eglTerminate(_display);
+}
+
+void HeadlessContext::makeCurrent() {
+	if (!eglMakeCurrent(_display, _surface, _surface, _context)) {
+		throw std::runtime_error(
+			"could not make the EGL context current in "
+			"HeadlessContext::makeCurrent");
+	}
+}
+
+bool HeadlessContext::isSupported() { return true; }
+
+#else  // SAI_GRAPHICS_USE_EGL
+
+HeadlessContext::HeadlessContext()
+	: _display(NULL), _context(NULL), _surface(NULL) {
+	throw std::runtime_error(
+		"sai-graphics was built without EGL support, headless rendering is "
+		"not available");
+}
+
+HeadlessContext::~HeadlessContext() {}
+
+void HeadlessContext::makeCurrent() {}
+
+bool HeadlessContext::isSupported() { return false; }
+
+#endif	// SAI_GRAPHICS_USE_EGL
+
+}  // namespace SaiGraphics
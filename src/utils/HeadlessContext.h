@@ -0,0 +1,58 @@
+/**
+ * \file HeadlessContext.h
+ *
+ * \brief Offscreen OpenGL context created through EGL, used to render the
+ * cameras of the graphics world on machines without a display.
+ */
+
+#ifndef SAI_GRAPHICS_HEADLESS_CONTEXT_H
+#define SAI_GRAPHICS_HEADLESS_CONTEXT_H
+
+namespace SaiGraphics {
+
+/**
+ * @brief OpenGL context without any window. It uses the EGL surfaceless
+ * platform when available (Mesa, including the llvmpipe software renderer on
+ * CPU only servers) and the default EGL display otherwise. The context does
+ * not have a default framebuffer, so everything needs to be rendered in frame
+ * buffer objects (as is done for the cameras of the graphics world).
+ *
+ * This requires the library to be built with EGL support (the EGL library is
+ * detected by cmake), otherwise the constructor throws.
+ */
+class HeadlessContext {
+public:
+	/**
+	 * @brief Creates the context and makes it current on the calling thread.
+	 * Throws a std::runtime_error if the context cannot be created.
+	 */
+	HeadlessContext();
+
+	/**
+	 * @brief Destroys the context
+	 *
+	 */
+	~HeadlessContext();
+
+	HeadlessContext(const HeadlessContext&) = delete;
+	HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+	/// @brief makes the context current on the calling thread
+	void makeCurrent();
+
+	/// @brief returns true if the library was built with EGL support
+	static bool isSupported();
+
+private:
+	/// @brief EGL display (EGLDisplay)
+	void* _display;
+	/// @brief EGL context (EGLContext)
+	void* _context;
+	/// @brief EGL pbuffer surface (EGLSurface), only created if surfaceless
+	/// contexts are not supported
+	void* _surface;
+};
+
+}  // namespace SaiGraphics
+
+#endif	// SAI_GRAPHICS_HEADLESS_CONTEXT_H
@@ -0,0 +1,108 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace SaiGraphics {
+
+ThreadPool::ThreadPool(const unsigned int num_threads)
+	: _task(nullptr),
+	  _num_tasks(0),
+	  _next_task(0),
+	  _active_workers(0),
+	  _job_id(0),
+	  _stop(false) {
+	unsigned int total_threads = num_threads;
+	if (total_threads == 0) {
+		total_threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	for (unsigned int i = 1; i < total_threads; ++i) {
+		_workers.emplace_back(&ThreadPool::workerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = true;
+	}
+	_job_cv.notify_all();
+	for (auto& worker : _workers) {
+		worker.join();
+	}
+}
+
+void ThreadPool::parallelFor(const size_t num_tasks,
+							 const std::function<void(size_t)>& task) {
+	if (num_tasks == 0) {
+		return;
+	}
+	// no need to wake up the workers for a single task
+	if (_workers.empty() || num_tasks == 1) {
+		for (size_t i = 0; i < num_tasks; ++i) {
+			task(i);
+		}
+		return;
+	}
+
+	std::lock_guard<std::mutex> call_lock(_parallel_for_mutex);
+	std::unique_lock<std::mutex> lock(_mutex);
+	_task = &task;
+	_num_tasks = num_tasks;
+	_next_task = 0;
+	_active_workers = _workers.size();
+	_exception = nullptr;
+	_job_id++;
+	lock.unlock();
+	_job_cv.notify_all();
+
+	// the calling thread works too
+	runTasks();
+
+	lock.lock();
+	_done_cv.wait(lock, [this] { return _active_workers == 0; });
+	_task = nullptr;
+	std::exception_ptr exception = _exception;
+	_exception = nullptr;
+	lock.unlock();
+
+	if (exception) {
+		std::rethrow_exception(exception);
+	}
+}
+
+void ThreadPool::runTasks() {
+	size_t i;
+	while ((i = _next_task.fetch_add(1)) < _num_tasks) {
+		try {
+			(*_task)(i);
+		} catch (...) {
+			std::lock_guard<std::mutex> lock(_mutex);
+			if (!_exception) {
+				_exception = std::current_exception();
+			}
+		}
+	}
+}
+
+void ThreadPool::workerLoop() {
+	unsigned long last_job_id = 0;
+	while (true) {
+		std::unique_lock<std::mutex> lock(_mutex);
+		_job_cv.wait(lock,
+					 [&] { return _stop || _job_id != last_job_id; });
+		if (_stop) {
+			return;
+		}
+		last_job_id = _job_id;
+		lock.unlock();
+
+		runTasks();
+
+		lock.lock();
+		if (--_active_workers == 0) {
+			_done_cv.notify_one();
+		}
+	}
+}
+
+}  // namespace SaiGraphics
@@ -0,0 +1,98 @@
+/**
+ * \file ThreadPool.h
+ *
+ * \brief Small fixed size pool of worker threads used to run independent
+ * tasks in parallel (robot kinematics updates, mesh loading...).
+ */
+
+#ifndef SAI_GRAPHICS_THREAD_POOL_H
+#define SAI_GRAPHICS_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SaiGraphics {
+
+/**
+ * @brief Pool of worker threads executing parallel for loops. The calling
+ * thread also takes part in the work, so a pool created for n threads spawns
+ * n-1 workers.
+ */
+class ThreadPool {
+public:
+	/**
+	 * @brief Creates the pool
+	 *
+	 * @param num_threads total number of threads running the tasks, including
+	 * the calling thread. 0 uses the number of hardware threads.
+	 */
+	explicit ThreadPool(const unsigned int num_threads = 0);
+
+	/**
+	 * @brief Stops and joins the worker threads
+	 *
+	 */
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	/// @brief total number of threads running the tasks, including the caller
+	unsigned int numThreads() const { return _workers.size() + 1; }
+
+	/**
+	 * @brief Runs task(i) for i in [0, num_tasks) on the pool and returns when
+	 * all the tasks are done. If tasks throw, the first exception is rethrown
+	 * on the calling thread once all the tasks are finished. Calls from
+	 * several threads are serialized.
+	 *
+	 * @param num_tasks number of tasks to run
+	 * @param task function called with the index of each task
+	 */
+	void parallelFor(const size_t num_tasks,
+					 const std::function<void(size_t)>& task);
+
+private:
+	/// @brief main loop of the worker threads
+	void workerLoop();
+
+	/// @brief runs tasks of the current job until there are none left
+	void runTasks();
+
+	/// @brief worker threads
+	std::vector<std::thread> _workers;
+
+	/// @brief serializes the calls to parallelFor
+	std::mutex _parallel_for_mutex;
+	/// @brief protects the job state below
+	std::mutex _mutex;
+	/// @brief signals workers that a new job is available or that the pool
+	/// stops
+	std::condition_variable _job_cv;
+	/// @brief signals the caller that all workers are done with the job
+	std::condition_variable _done_cv;
+
+	/// @brief task of the current job
+	const std::function<void(size_t)>* _task;
+	/// @brief number of tasks of the current job
+	size_t _num_tasks;
+	/// @brief index of the next task to run
+	std::atomic<size_t> _next_task;
+	/// @brief number of workers still running the current job
+	size_t _active_workers;
+	/// @brief id of the current job, incremented for each new job
+	unsigned long _job_id;
+	/// @brief first exception thrown by a task of the current job
+	std::exception_ptr _exception;
+	/// @brief flag to stop the workers
+	bool _stop;
+};
+
+}  // namespace SaiGraphics
+
+#endif	// SAI_GRAPHICS_THREAD_POOL_H
@@ -0,0 +1,106 @@
+/**
+ * \file TripleBuffer.h
+ *
+ * \brief Lock-free single producer, single consumer triple buffer used to pass
+ * the latest state of the robots and objects from a simulation thread to the
+ * rendering thread.
+ */
+
+#ifndef SAI_GRAPHICS_TRIPLE_BUFFER_H
+#define SAI_GRAPHICS_TRIPLE_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace SaiGraphics {
+
+/**
+ * @brief Triple buffer holding three copies of a value. The producer fills the
+ * write buffer and publishes it, the consumer fetches the most recently
+ * published value into its read buffer. Neither side ever blocks or waits for
+ * the other, and values that are published several times before the consumer
+ * fetches them are simply overwritten.
+ *
+ * Only one thread may write and one thread may read a given buffer. As the
+ * buffers are reused, a value containing dynamic containers (Eigen::VectorXd
+ * for example) does not allocate once all three buffers have been filled with
+ * values of the right size.
+ *
+ * @tparam T type of the stored value
+ */
+template <typename T>
+class TripleBuffer {
+public:
+	/**
+	 * @brief Creates the buffer with the three copies initialized to the
+	 * given value
+	 *
+	 * @param initial_value initial value of the three copies
+	 */
+	explicit TripleBuffer(const T& initial_value = T())
+		: _write_index(0), _shared_state(1), _read_index(2) {
+		for (auto& slot : _slots) {
+			slot.value = initial_value;
+		}
+	}
+
+	TripleBuffer(const TripleBuffer&) = delete;
+	TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+	/// @brief buffer to fill on the producer side before calling publish
+	T& writeBuffer() { return _slots[_write_index].value; }
+
+	/**
+	 * @brief Makes the content of the write buffer available to the consumer.
+	 * Producer side only.
+	 */
+	void publish() {
+		const uint8_t previous = _shared_state.exchange(
+			_write_index | NEW_DATA_FLAG, std::memory_order_acq_rel);
+		_write_index = previous & INDEX_MASK;
+	}
+
+	/**
+	 * @brief Fetches the latest published value in the read buffer if a new
+	 * one was published since the last call. Consumer side only.
+	 *
+	 * @return true if a new value was fetched, false if the read buffer is
+	 * unchanged
+	 */
+	bool fetch() {
+		if ((_shared_state.load(std::memory_order_relaxed) & NEW_DATA_FLAG) ==
+			0) {
+			return false;
+		}
+		const uint8_t previous =
+			_shared_state.exchange(_read_index, std::memory_order_acq_rel);
+		_read_index = previous & INDEX_MASK;
+		return true;
+	}
+
+	/// @brief latest value fetched by the consumer
+	const T& readBuffer() const { return _slots[_read_index].value; }
+
+private:
+	static constexpr uint8_t INDEX_MASK = 0x3;
+	static constexpr uint8_t NEW_DATA_FLAG = 0x4;
+
+	/// @brief copies of the value, on separate cache lines so that the
+	/// producer and consumer don't write to the same line
+	struct alignas(64) Slot {
+		T value;
+	};
+	Slot _slots[3];
+
+	/// @brief index of the buffer owned by the producer
+	alignas(64) uint8_t _write_index;
+	/// @brief index of the buffer shared between producer and consumer, with
+	/// the flag telling if it holds a value not fetched yet
+	alignas(64) std::atomic<uint8_t> _shared_state;
+	/// @brief index of the buffer owned by the consumer
+	alignas(64) uint8_t _read_index;
+};
+
+}  // namespace SaiGraphics
+
+#endif	// SAI_GRAPHICS_TRIPLE_BUFFER_H